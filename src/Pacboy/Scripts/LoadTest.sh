@@ -0,0 +1,57 @@
+#!/bin/sh
+# Load tests a local dedicated server with headless bot clients (see APacboyBotDriver and APacboyLoadReport).
+# Nothing is rendered, so it runs on a single Linux box.
+#
+# Usage: LoadTest.sh [Bots] [Seconds] [Profile]
+#   Bots    - The number of bot clients (32 by default)
+#   Seconds - The duration of the run (300 by default)
+#   Profile - Wander, Gunner, Mixed or Circle (Mixed by default)
+#
+# Environment:
+#   UE4_EDITOR - The editor binary (UE4Editor by default)
+#   SERVER     - The server command (the editor with -server by default). Set it to the PacboyServer binary
+#                to compare the server build, where the cosmetic code is compiled out, with the game build
+#   MAP        - The map of the server (/Game/Levels/Tunnel by default)
+#   REPORT     - The time between two load reports of the server (5 seconds by default)
+#
+# The server log (LoadTestServer.log) gets a "Load:" line every REPORT seconds and a "Load (whole run):"
+# line at the end, and Saved/Profiling/NetStats.csv gets the per RPC and per property traffic.
+
+BOTS=${1:-32}
+DURATION=${2:-300}
+PROFILE=${3:-Mixed}
+
+UE4_EDITOR=${UE4_EDITOR:-UE4Editor}
+MAP=${MAP:-/Game/Levels/Tunnel}
+REPORT=${REPORT:-5}
+
+PROJECT="$(cd "$(dirname "$0")/.." && pwd)/Pacboy.uproject"
+
+SERVER=${SERVER:-"$UE4_EDITOR $PROJECT"}
+
+# The players connect after a while, so the first reports are the idle load
+$SERVER "$MAP" -server -nullrhi -unattended -PacboyLoadReport="$REPORT" -NetStatsCSV="$REPORT" -log=LoadTestServer.log &
+SERVER_PID=$!
+
+# Give the server time to load the map
+sleep 20
+
+CLIENTS=""
+i=1
+while [ "$i" -le "$BOTS" ]; do
+	"$UE4_EDITOR" "$PROJECT" 127.0.0.1 -game -nullrhi -nosound -unattended -PacboyBot="$PROFILE" -PacboyBotSeed="$i" -log=LoadTestBot$i.log &
+	CLIENTS="$CLIENTS $!"
+	i=$((i + 1))
+	sleep 1
+done
+
+sleep "$DURATION"
+
+kill $CLIENTS 2>/dev/null
+wait $CLIENTS 2>/dev/null
+
+# The server writes the summary of the run when it ends
+kill -INT "$SERVER_PID"
+wait "$SERVER_PID"
+
+grep "Load" "$(dirname "$PROJECT")/Saved/Logs/LoadTestServer.log"
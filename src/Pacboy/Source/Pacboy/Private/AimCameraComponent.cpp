@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Pacboy.h"
+#include "AimCameraComponent.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Aim Camera Transition Ticks"), STAT_AimCameraTransitionTicks, STATGROUP_Pacboy);
+
+UAimCameraComponent::UAimCameraComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	this->PrimaryComponentTick.bCanEverTick = true;
+
+	// Only ticks during a transition (see MoveTo)
+	this->PrimaryComponentTick.bStartWithTickEnabled = false;
+
+	this->ConvergenceTolerance = 1.f;
+
+	this->CameraBoom = NULL;
+	this->CameraBoomExtension = NULL;
+	this->TargetCameraBoomLength = 0.f;
+	this->TargetCameraBoomExtensionLength = 0.f;
+	this->TransitionSmoothSpeed = 0.f;
+}
+
+void UAimCameraComponent::SetCameraBooms(USpringArmComponent* InCameraBoom, USpringArmComponent* InCameraBoomExtension)
+{
+	this->CameraBoom = InCameraBoom;
+	this->CameraBoomExtension = InCameraBoomExtension;
+}
+
+void UAimCameraComponent::MoveTo(float CameraBoomLength, float CameraBoomExtensionLength, float SmoothSpeed)
+{
+	const APawn* Pawn = Cast<APawn>(this->GetOwner());
+
+	if ((Pawn == NULL) || (this->CameraBoom == NULL) || (this->CameraBoomExtension == NULL))
+	{
+		return;
+	}
+
+	this->TargetCameraBoomLength = CameraBoomLength;
+	this->TargetCameraBoomExtensionLength = CameraBoomExtensionLength;
+	this->TransitionSmoothSpeed = SmoothSpeed;
+
+	if (Pawn->IsLocallyControlled() && ShouldPlayCosmetics(this->GetWorld()))
+	{
+		this->SetComponentTickEnabled(true);
+	}
+	else if (Pawn->Role == ROLE_Authority)
+	{
+		// Nobody sees the camera, but the shots start from it
+		this->SnapToTarget();
+	}
+}
+
+void UAimCameraComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	INC_DWORD_STAT(STAT_AimCameraTransitionTicks);
+
+	if ((this->CameraBoom == NULL) || (this->CameraBoomExtension == NULL))
+	{
+		this->SetComponentTickEnabled(false);
+		return;
+	}
+
+	const float Alpha = FMath::Clamp(this->TransitionSmoothSpeed * DeltaTime, 0.f, 1.f);
+
+	this->CameraBoom->TargetArmLength = FMath::Lerp(this->CameraBoom->TargetArmLength, this->TargetCameraBoomLength, Alpha);
+	this->CameraBoomExtension->TargetArmLength = FMath::Lerp(this->CameraBoomExtension->TargetArmLength, this->TargetCameraBoomExtensionLength, Alpha);
+
+	if ((FMath::Abs(this->CameraBoom->TargetArmLength - this->TargetCameraBoomLength) <= this->ConvergenceTolerance) &&
+		(FMath::Abs(this->CameraBoomExtension->TargetArmLength - this->TargetCameraBoomExtensionLength) <= this->ConvergenceTolerance))
+	{
+		this->SnapToTarget();
+		this->SetComponentTickEnabled(false);
+	}
+}
+
+void UAimCameraComponent::SnapToTarget()
+{
+	this->CameraBoom->TargetArmLength = this->TargetCameraBoomLength;
+	this->CameraBoomExtension->TargetArmLength = this->TargetCameraBoomExtensionLength;
+}
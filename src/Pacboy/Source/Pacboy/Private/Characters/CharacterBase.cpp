@@ -2,11 +2,78 @@
 
 #include "Pacboy.h"
 #include "CharacterBase.h"
+#include "ProjectilePool.h"
+#include "FXPool.h"
+#include "NetRelevancyGrid.h"
+#include "SignificanceManager.h"
+#include "PacboyGameMode.h"
+#include "LoadReport.h"
+#include "NetStats.h"
+#include "DamageQueue.h"
 
 #include "UnrealNetwork.h"
 
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Fire Commands Processed"), STAT_FireCommandsProcessed, STATGROUP_Pacboy);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Fire Commands Duplicated"), STAT_FireCommandsDuplicated, STATGROUP_Pacboy);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Fire Commands Lost"), STAT_FireCommandsLost, STATGROUP_Pacboy);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Fire Commands Rejected"), STAT_FireCommandsRejected, STATGROUP_Pacboy);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Hits Rejected"), STAT_HitsRejected, STATGROUP_Pacboy);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Scheduled Shots"), STAT_ScheduledShots, STATGROUP_Pacboy);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Wall Detection Traces Per Second"), STAT_WallDetectionTraces, STATGROUP_Pacboy);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Wall Contact Cache Hits Per Second"), STAT_WallContactCacheHits, STATGROUP_Pacboy);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Character Ticks Skipped"), STAT_CharacterTicksSkipped, STATGROUP_Pacboy);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Characters Spawned"), STAT_CharactersSpawned, STATGROUP_Pacboy);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Characters Destroyed"), STAT_CharactersDestroyed, STATGROUP_Pacboy);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Characters Recycled"), STAT_CharactersRecycled, STATGROUP_Pacboy);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Weapons Spawned"), STAT_WeaponsSpawned, STATGROUP_Pacboy);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Weapons Destroyed"), STAT_WeaponsDestroyed, STATGROUP_Pacboy);
+
+/** The wall detection traces and cache hits of the current second (wall jumps are too rare to be read per frame) */
+static uint32 WallDetectionTraces = 0;
+static uint32 WallContactCacheHits = 0;
+
+#if STATS
+
+static float WallDetectionStatsTime = 0.f;
+
+/** Sets the wall detection stats to their rates once per second */
+static bool TickWallDetectionStats(float DeltaTime)
+{
+	WallDetectionStatsTime += DeltaTime;
+
+	if (WallDetectionStatsTime >= 1.f)
+	{
+		SET_DWORD_STAT(STAT_WallDetectionTraces, FMath::RoundToInt(WallDetectionTraces / WallDetectionStatsTime));
+		SET_DWORD_STAT(STAT_WallContactCacheHits, FMath::RoundToInt(WallContactCacheHits / WallDetectionStatsTime));
+
+		WallDetectionTraces = 0;
+		WallContactCacheHits = 0;
+		WallDetectionStatsTime = 0.f;
+	}
+
+	return true;
+}
+
+#endif
+
+/** Counts a wall detection trace or cache hit. The stats are ticked from the first one */
+static void CountWallDetection(uint32& Count)
+{
+#if STATS
+	static bool bIsTicking = false;
+
+	if (!bIsTicking)
+	{
+		FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&TickWallDetectionStats));
+		bIsTicking = true;
+	}
+
+	Count++;
+#endif
+}
+
 ACharacterBase::ACharacterBase(const FObjectInitializer& ObjectInitializer)
-	: Super(ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UPacboyCharacterMovement>(ACharacter::CharacterMovementComponentName))
 {
 	this->GetCapsuleComponent()->InitCapsuleSize(55.f, 88.f);
 
@@ -39,7 +106,29 @@ ACharacterBase::ACharacterBase(const FObjectInitializer& ObjectInitializer)
 
 	this->MaxWallJumps = -1;
 
-	this->FirstShot = true;
+	this->LagCompensation = ObjectInitializer.CreateDefaultSubobject<ULagCompensationComponent>(this, FName(TEXT("LagCompensation")));
+	this->MaxLagCompensation = 0.25f;
+
+	this->bHasReceivedState = false;
+
+	this->EnergyBase = 0.f;
+	this->EnergyRate = 0.f;
+	this->EnergyTimestamp = 0.f;
+	this->EnergyEpoch = 0;
+
+	this->NextFireSequence = 0;
+	this->LastSentFireSequence = 0;
+	this->LastProcessedFireSequence = 0;
+	this->LastProcessedFireTime = -MAX_FLT;
+	this->ClientClockOffset = MAX_FLT;
+	this->FireTokens = FWeaponFireScheduler::MaxShotsPerAdvance;
+	this->FireTokensTime = 0.f;
+	this->bHasProcessedFireCommand = false;
+
+	this->Significance = ECharacterSignificance::High;
+	this->SignificanceScore = 1.f;
+	this->SignificanceTickInterval = 0.f;
+	this->SkippedTickTime = 0.f;
 
 	// Note: The skeletal mesh and animation blueprint references on the Mesh component (inherited from Character) 
 	// are set in the derived blueprint asset named BP_MainCharacter (to avoid direct content references in C++)
@@ -50,68 +139,227 @@ void ACharacterBase::BeginPlay()
 	Super::BeginPlay();
 
 	this->Health = this->HealthCapacity;
-	this->Energy = this->EnergyCapacity;
+	this->SetEnergy(this->EnergyCapacity);
 
 	this->GetCharacterMovement()->MaxWalkSpeed = this->JogSpeed;
 
-	if (this->RifleClass != NULL)
+	this->DefaultMeshUpdateFlag = this->GetMesh()->MeshComponentUpdateFlag;
+
+	ASignificanceManager* SignificanceManager = ASignificanceManager::Get(this->GetWorld());
+	if (SignificanceManager != NULL)
 	{
-		AWeapon* RifleWeapon = Cast<AWeapon>(this->RifleClass->GetDefaultObject());
+		SignificanceManager->RegisterCharacter(this);
+	}
 
-		if (RifleWeapon != NULL)
-		{
-			this->Rifle = this->GetWorld()->SpawnActor<AWeapon>(this->RifleClass);
-			this->Rifle->Init(*RifleWeapon);
+	INC_DWORD_STAT(STAT_CharactersSpawned);
+	APacboyLoadReport::RecordActorSpawned();
 
-			this->Rifle->WeaponMesh->AttachTo(this->GetMesh(), this->WeaponSocketName, EAttachLocation::SnapToTarget, true);
+	this->Rifle = this->SpawnWeapon(this->RifleClass);
+	this->EquippedWeapon = this->Rifle;
 
-			this->EquippedWeapon = this->Rifle;
-		}
+	this->RocketLauncher = this->SpawnWeapon(this->RocketLauncherClass);
+	if (this->RocketLauncher != NULL)
+	{
+		this->RocketLauncher->SetActorHiddenInGame(true);
 	}
 
-	if (this->RocketLauncherClass != NULL)
+	if (Role == ROLE_Authority)
 	{
-		AWeapon* RocketLauncherWeapon = Cast<AWeapon>(this->RocketLauncherClass->GetDefaultObject());
+		this->PrewarmProjectiles(this->Rifle);
+		this->PrewarmProjectiles(this->RocketLauncher);
 
-		if (RocketLauncherWeapon != NULL)
+		ANetRelevancyGrid* RelevancyGrid = ANetRelevancyGrid::Get(this->GetWorld());
+		if (RelevancyGrid != NULL)
 		{
-			this->RocketLauncher = this->GetWorld()->SpawnActor<AWeapon>(this->RocketLauncherClass);
-			this->RocketLauncher->Init(*RocketLauncherWeapon);
+			RelevancyGrid->UpdateActor(this);
+		}
+	}
+}
 
-			this->RocketLauncher->WeaponMesh->AttachTo(this->GetMesh(), this->WeaponSocketName, EAttachLocation::SnapToTarget, true);
+void ACharacterBase::PrewarmProjectiles(const AWeapon* Weapon)
+{
+	if ((Weapon == NULL) || (Weapon->GetDefinition()->ProjectileClass == NULL))
+	{
+		return;
+	}
 
-			this->RocketLauncher->SetActorHiddenInGame(true);
-		}
+	AProjectilePool* ProjectilePool = AProjectilePool::Get(this->GetWorld());
+	if (ProjectilePool == NULL)
+	{
+		return;
+	}
+
+	const UWeaponDefinition* WeaponDefinition = Weapon->GetDefinition();
+
+	// Enough projectiles for one player firing non-stop for the projectile's whole life span
+	const AProjectileBase* Projectile = WeaponDefinition->ProjectileClass->GetDefaultObject<AProjectileBase>();
+	const int32 Count = FMath::CeilToInt(WeaponDefinition->ShotsPerSecond * FMath::Max(Projectile->InitialLifeSpan, 1.f));
+
+	ProjectilePool->Prewarm(WeaponDefinition->ProjectileClass, Count);
+}
+
+AWeapon* ACharacterBase::SpawnWeapon(TSubclassOf<AWeapon> WeaponClass)
+{
+	if (WeaponClass == NULL)
+	{
+		return NULL;
+	}
+
+	AWeapon* Weapon = this->GetWorld()->SpawnActor<AWeapon>(WeaponClass);
+	if (Weapon == NULL)
+	{
+		return NULL;
+	}
+
+	if (Weapon->Definition == NULL)
+	{
+		UE_LOG(LogPacboy, Warning, TEXT("The weapon class %s has no weapon definition"), *WeaponClass->GetName());
 	}
 
-	this->GetWorldTimerManager().SetTimer(this, &ACharacterBase::UpdateEnergy, 0.1f, true);
+	Weapon->Init();
+	Weapon->SetOwner(this);
+
+	Weapon->WeaponMesh->AttachTo(this->GetMesh(), this->WeaponSocketName, EAttachLocation::SnapToTarget, true);
+
+	INC_DWORD_STAT(STAT_WeaponsSpawned);
+	APacboyLoadReport::RecordActorSpawned();
+
+	return Weapon;
 }
 
 void ACharacterBase::GetLifetimeReplicatedProps(TArray< class FLifetimeProperty > & OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(ACharacterBase, Health);
-	DOREPLIFETIME(ACharacterBase, Energy);
-	DOREPLIFETIME(ACharacterBase, bIsSprinting);
-	DOREPLIFETIME(ACharacterBase, bIsReloading);
-	DOREPLIFETIME(ACharacterBase, bIsAiming);
-	DOREPLIFETIME(ACharacterBase, bIsFiring);
-	DOREPLIFETIME(ACharacterBase, bIsDead);
-	DOREPLIFETIME(ACharacterBase, ReloadAnimTimeRemaining);
-	DOREPLIFETIME(ACharacterBase, CharPitch);
-	DOREPLIFETIME(ACharacterBase, FirstShot);
-	DOREPLIFETIME(ACharacterBase, DelayShot);
-	DOREPLIFETIME(ACharacterBase, ShootingGateOpen);
-	DOREPLIFETIME(ACharacterBase, FireFromClient);
-	DOREPLIFETIME(ACharacterBase, bReloadClient);
+	DOREPLIFETIME(ACharacterBase, ReplicatedState);
+}
+
+void ACharacterBase::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+	Super::PreReplication(ChangedPropertyTracker);
+
+	// Packed once per net update, the packed state is then compared once per connection
+	this->ReplicatedState = this->PackReplicatedState();
+}
+
+bool ACharacterBase::CallRemoteFunction(UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack)
+{
+#if PACBOY_NET_STATS
+	FNetStatsRPCScope NetStatsScope(this, Function);
+#endif
+
+	return Super::CallRemoteFunction(Function, Parameters, OutParms, Stack);
+}
+
+bool ACharacterBase::IsNetRelevantFor(APlayerController* RealViewer, AActor* Viewer, const FVector& SrcLocation)
+{
+	ANetRelevancyGrid* RelevancyGrid = ANetRelevancyGrid::Get(this->GetWorld());
+
+	if ((RelevancyGrid == NULL) || !RelevancyGrid->IsTrackingViewer(RealViewer) ||
+		this->bAlwaysRelevant || this->IsOwnedBy(Viewer) || this->IsOwnedBy(RealViewer) || (this == Viewer) || (Viewer == this->Instigator))
+	{
+		return Super::IsNetRelevantFor(RealViewer, Viewer, SrcLocation);
+	}
+
+	return RelevancyGrid->IsRelevantFor(this, RealViewer);
+}
+
+float ACharacterBase::GetNetPriority(const FVector& ViewPos, const FVector& ViewDir, APlayerController* Viewer, UActorChannel* InChannel, float Time, bool bLowBandwidth)
+{
+	ANetRelevancyGrid* RelevancyGrid = ANetRelevancyGrid::Get(this->GetWorld());
+
+	// The player's own character keeps the engine priority
+	if ((RelevancyGrid == NULL) || !RelevancyGrid->IsRelevantFor(this, Viewer) || (Viewer->GetPawn() == this))
+	{
+		return Super::GetNetPriority(ViewPos, ViewDir, Viewer, InChannel, Time, bLowBandwidth);
+	}
+
+	return this->NetPriority * Time * RelevancyGrid->GetPriorityScale(this, Viewer);
+}
+
+FCharacterReplicatedState ACharacterBase::PackReplicatedState() const
+{
+	FCharacterReplicatedState State;
+
+	State.SetFlag(ECharacterStateFlags::Sprinting, this->bIsSprinting);
+	State.SetFlag(ECharacterStateFlags::Aiming, this->bIsAiming);
+	State.SetFlag(ECharacterStateFlags::Firing, this->bIsFiring);
+	State.SetFlag(ECharacterStateFlags::Reloading, this->bIsReloading);
+	State.SetFlag(ECharacterStateFlags::Dead, this->bIsDead);
+
+	State.Health = FCharacterReplicatedState::QuantizeValue(this->Health);
+	State.EnergyBase = FCharacterReplicatedState::QuantizeValue(this->EnergyBase);
+	State.EnergyRate = FCharacterReplicatedState::QuantizeRate(this->EnergyRate);
+	State.EnergyEpoch = this->EnergyEpoch;
+	State.CharPitch = FRotator::CompressAxisToShort(this->CharPitch);
+
+	return State;
+}
+
+/** Applies a state flag if it was changed on the server */
+static void ApplyChangedFlag(const FCharacterReplicatedState& State, uint16 ChangedFlags, ECharacterStateFlags::Type Flag, bool& OutValue)
+{
+	if ((ChangedFlags & Flag) != 0)
+	{
+		OutValue = State.HasFlag(Flag);
+	}
+}
+
+void ACharacterBase::OnRep_ReplicatedState()
+{
+	const FCharacterReplicatedState& State = this->ReplicatedState;
+	const FCharacterReplicatedState& Last = this->LastReceivedState;
+
+	// Like separately replicated properties, only the values that changed on the server
+	// overwrite the local ones (so the locally predicted values stay untouched)
+	const bool bApplyAll = !this->bHasReceivedState;
+	const uint16 ChangedFlags = bApplyAll ? MAX_uint16 : (State.Flags ^ Last.Flags);
+
+	ApplyChangedFlag(State, ChangedFlags, ECharacterStateFlags::Sprinting, this->bIsSprinting);
+	ApplyChangedFlag(State, ChangedFlags, ECharacterStateFlags::Aiming, this->bIsAiming);
+	ApplyChangedFlag(State, ChangedFlags, ECharacterStateFlags::Firing, this->bIsFiring);
+	ApplyChangedFlag(State, ChangedFlags, ECharacterStateFlags::Dead, this->bIsDead);
+
+	if (bApplyAll || (State.Health != Last.Health))
+	{
+		this->Health = FCharacterReplicatedState::DequantizeValue(State.Health);
+	}
+
+	if (bApplyAll || (State.EnergyEpoch != Last.EnergyEpoch) || (State.EnergyBase != Last.EnergyBase) || (State.EnergyRate != Last.EnergyRate))
+	{
+		// The energy is evaluated from the time the reset was received
+		this->ResetEnergy(FCharacterReplicatedState::DequantizeValue(State.EnergyBase), FCharacterReplicatedState::DequantizeRate(State.EnergyRate));
+	}
+
+	// Only the start and the end of a reload are replicated. The reload is timed locally from when the
+	// start is received (or predicted), and the end only completes a reload that is still running here
+	if ((ChangedFlags & ECharacterStateFlags::Reloading) != 0)
+	{
+		const bool bServerReloading = State.HasFlag(ECharacterStateFlags::Reloading);
+
+		// The owning client may have finished its predicted reload before the start arrives
+		if (bServerReloading && !this->bIsReloading && (!this->IsLocallyControlled() || this->CanReload()))
+		{
+			this->BeginReload();
+		}
+		else if (!bServerReloading && this->bIsReloading)
+		{
+			this->Reload();
+		}
+	}
+
+	if (bApplyAll || (State.CharPitch != Last.CharPitch))
+	{
+		this->CharPitch = FRotator::DecompressAxisFromShort(State.CharPitch);
+	}
+
+	this->LastReceivedState = State;
+	this->bHasReceivedState = true;
 }
 
 void ACharacterBase::SwapToRifle()
 {
-	this->bIsReloading = false;
-	this->StopAnimMontage(this->ReloadAnim);
-	this->RestartReloadAnimTimeRemaining();
+	this->CancelReload();
 
 	if (Role < ROLE_Authority)
 	{
@@ -147,17 +395,15 @@ void ACharacterBase::SwapToRifle_Multicast_Implementation()
 {
 	this->StopAnimMontage(this->ReloadAnim);
 
+	this->EquippedWeapon->FireScheduler.Disarm();
 	this->EquippedWeapon->SetActorHiddenInGame(true);
 	this->EquippedWeapon = this->Rifle;
 	this->EquippedWeapon->SetActorHiddenInGame(false);
-	this->FirstShot = true;
 }
 
 void ACharacterBase::SwapToRocketLauncher()
 {
-	this->bIsReloading = false;
-	this->StopAnimMontage(this->ReloadAnim);
-	this->RestartReloadAnimTimeRemaining();
+	this->CancelReload();
 
 	if (Role < ROLE_Authority)
 	{
@@ -193,37 +439,88 @@ void ACharacterBase::SwapToRocketLauncher_Multicast_Implementation()
 {
 	this->StopAnimMontage(this->ReloadAnim);
 
+	this->EquippedWeapon->FireScheduler.Disarm();
 	this->EquippedWeapon->SetActorHiddenInGame(true);
 	this->EquippedWeapon = this->RocketLauncher;
 	this->EquippedWeapon->SetActorHiddenInGame(false);
-	this->FirstShot = true;
 }
 
 void ACharacterBase::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
-	if (bIsReloading)
+	// The simulated proxies use the energy rate sent by the server
+	if (Role >= ROLE_AutonomousProxy)
 	{
-		this->ReloadAnimTimeRemaining -= DeltaTime;
+		this->UpdateEnergyRate();
+	}
+
+	if (this->IsLocallyControlled())
+	{
+		this->Energy = this->GetEnergy();
+		this->UpdateFire();
+	}
+	else if (Role == ROLE_Authority)
+	{
+		// The shots of a remote player arrive with its fire commands, the flag only drives the animations
+		this->bIsFiring = this->GetPacboyMovement()->bWantsToFire && this->CanFire();
+	}
 
-		if (ReloadAnimTimeRemaining <= 0.f)
+	if (Role == ROLE_AutonomousProxy)
+	{
+		this->FlushFireCommands();
+	}
+	else if (Role == ROLE_Authority)
+	{
+		ANetRelevancyGrid* RelevancyGrid = ANetRelevancyGrid::Get(this->GetWorld());
+		if (RelevancyGrid != NULL)
 		{
-			this->RestartReloadAnimTimeRemaining();
-			this->StopAnimMontage(this->ReloadAnim);
-			this->Reload();
+			RelevancyGrid->UpdateActor(this);
 		}
 	}
 }
 
-bool ACharacterBase::RestartReloadAnimTimeRemaining_Validate()
+void ACharacterBase::TickActor(float DeltaTime, enum ELevelTick TickType, FActorTickFunction& ThisTickFunction)
 {
-	return true;
+	if (this->SignificanceTickInterval > 0.f)
+	{
+		this->SkippedTickTime += DeltaTime;
+
+		if (this->SkippedTickTime < this->SignificanceTickInterval)
+		{
+			INC_DWORD_STAT(STAT_CharacterTicksSkipped);
+			return;
+		}
+
+		// The skipped time is caught up by the next tick
+		DeltaTime = this->SkippedTickTime;
+		this->SkippedTickTime = 0.f;
+	}
+
+	Super::TickActor(DeltaTime, TickType, ThisTickFunction);
 }
 
-void ACharacterBase::RestartReloadAnimTimeRemaining_Implementation()
+void ACharacterBase::SetSignificance(ECharacterSignificance::Type NewSignificance, float TickInterval)
 {
-	this->ReloadAnimTimeRemaining = 0.f;
+	if (TickInterval != this->SignificanceTickInterval)
+	{
+		// Spread the ticks of the characters that switch to the same interval over the interval
+		this->SkippedTickTime = (this->SignificanceTickInterval > 0.f) ? this->SkippedTickTime : FMath::FRand() * TickInterval;
+		this->SignificanceTickInterval = TickInterval;
+	}
+
+	if (NewSignificance == this->Significance)
+	{
+		return;
+	}
+
+	this->Significance = NewSignificance;
+
+	const bool bLowSignificance = (NewSignificance == ECharacterSignificance::Low);
+
+	// The characters of low significance are only animated while rendered, and snap to the corrected locations
+	this->GetMesh()->MeshComponentUpdateFlag = bLowSignificance ? TEnumAsByte<EMeshComponentUpdateFlag::Type>(EMeshComponentUpdateFlag::OnlyTickPoseWhenRendered) : this->DefaultMeshUpdateFlag;
+	this->GetPacboyMovement()->bSkipNetworkSmoothing = bLowSignificance;
 }
 
 void ACharacterBase::Jump()
@@ -233,71 +530,61 @@ void ACharacterBase::Jump()
 		return;
 	}
 
-	if ((this->MaxWallJumps != -1) && (this->JumpCount > this->MaxWallJumps))
+	// The jump input is sent to the server with the saved moves, and the movement component
+	// performs the ground jump or the wall jump (see UPacboyCharacterMovement::DoJump)
+	Super::Jump();
+}
+
+bool ACharacterBase::CanJumpInternal_Implementation() const
+{
+	if (this->bIsDead)
 	{
-		return;
+		return false;
 	}
 
-	if (Role < ROLE_Authority)
+	if ((this->MaxWallJumps != -1) && (this->JumpCount > this->MaxWallJumps))
 	{
-		this->Jump_Server();
+		return false;
 	}
 
-	if (!this->GetCharacterMovement()->IsFalling())
+	if (this->GetCharacterMovement()->IsFalling())
 	{
-		Super::Jump();
-		this->JumpCount++;
+		return true;
 	}
-	else
-	{
-		DetectWallResult DetectWallResult = this->DetectWall();
-		//GEngine->AddOnScreenDebugMessage(0, 10.f, FColor::Cyan, "banana");
 
-		if (!DetectWallResult.HitWall)
-		{
-			//GEngine->AddOnScreenDebugMessage(0, 10.f, FColor::Cyan, "fail-banana");
-			return;
-		}
+	return Super::CanJumpInternal_Implementation();
+}
 
-		if (!this->UseEnergy(this->WallJumpEnergy))
-		{
-			return;
-		}
+bool ACharacterBase::GetWallJumpVelocity(FVector& OutVelocity)
+{
+	DetectWallResult DetectWallResult = this->DetectWall();
+
+	if (!DetectWallResult.HitWall)
+	{
+		return false;
+	}
 
-		const FVector UpLaunchVelocity = this->GetActorUpVector() * 1050;
-		FVector FullLaunchVelocity;
+	const FVector UpLaunchVelocity = this->GetActorUpVector() * 1050;
 
-		if (DetectWallResult.HitSide)
+	if (DetectWallResult.HitSide)
+	{
+		if (DetectWallResult.RightSideHit)
 		{
-			if (DetectWallResult.RightSideHit)
-			{
-				FullLaunchVelocity = (this->GetActorRightVector() * -1000) + UpLaunchVelocity;
-			}
-			else
-			{
-				FullLaunchVelocity = (this->GetActorRightVector() * 1000) + UpLaunchVelocity;
-			}
+			OutVelocity = (this->GetActorRightVector() * -1000) + UpLaunchVelocity;
 		}
 		else
 		{
-			FullLaunchVelocity = (this->GetActorForwardVector() * -1000) + UpLaunchVelocity;
+			OutVelocity = (this->GetActorRightVector() * 1000) + UpLaunchVelocity;
 		}
-		this->LaunchCharacter(FullLaunchVelocity, true, true);
-
-		this->JumpCount++;
 	}
-}
+	else
+	{
+		OutVelocity = (this->GetActorForwardVector() * -1000) + UpLaunchVelocity;
+	}
 
-bool ACharacterBase::Jump_Server_Validate()
-{
 	return true;
 }
 
-void ACharacterBase::Jump_Server_Implementation()
-{
-	this->Jump();
-}
-
 void ACharacterBase::Landed(const FHitResult& Hit)
 {
 	Super::Landed(Hit);
@@ -314,6 +601,26 @@ ACharacterBase::DetectWallResult ACharacterBase::DetectWall()
 {
 	DetectWallResult Result{ false, false, false };
 
+	// Use the wall the character ran into while moving, if it is still close enough
+	FVector WallNormal;
+	if (this->GetPacboyMovement()->FindWallContact(WallNormal))
+	{
+		CountWallDetection(WallContactCacheHits);
+
+		Result.HitWall = true;
+
+		// The walls within 45 degrees of the character's sides are side walls
+		const float RightDot = FVector::DotProduct(-WallNormal, this->GetActorRightVector());
+
+		if (FMath::Abs(RightDot) >= 0.707f)
+		{
+			Result.HitSide = true;
+			Result.RightSideHit = (RightDot > 0.f);
+		}
+
+		return Result;
+	}
+
 	FName TraceTag = FName(TEXT("WallTrace"));
 	//GetWorld()->DebugDrawTraceTag = TraceTag;
 
@@ -324,6 +631,7 @@ ACharacterBase::DetectWallResult ACharacterBase::DetectWall()
 	FHitResult SphereHitResult(ForceInit);
 	const FVector SphereTraceEnd = (this->GetActorUpVector() * 100) + TraceStart;
 
+	CountWallDetection(WallDetectionTraces);
 	bool WallFound = this->GetWorld()->SweepSingle(SphereHitResult, TraceStart, SphereTraceEnd, FQuat(), FCollisionShape::MakeSphere(60.f), QueryParams, ObjectQueryParams);
 
 	if (!WallFound)
@@ -336,6 +644,7 @@ ACharacterBase::DetectWallResult ACharacterBase::DetectWall()
 	FHitResult RightSideHitResult(ForceInit);
 	const FVector RightSideTraceEnd = (this->GetActorRightVector() * 100) + TraceStart;
 
+	CountWallDetection(WallDetectionTraces);
 	bool RightSideHit = this->GetWorld()->LineTraceSingle(RightSideHitResult, TraceStart, RightSideTraceEnd, QueryParams, ObjectQueryParams);
 
 	if (RightSideHit)
@@ -350,6 +659,7 @@ ACharacterBase::DetectWallResult ACharacterBase::DetectWall()
 	FHitResult LeftSideHitResult(ForceInit);
 	const FVector LeftSideTraceEnd = (this->GetActorRightVector() * -100) + TraceStart;
 
+	CountWallDetection(WallDetectionTraces);
 	bool LeftSideHit = this->GetWorld()->LineTraceSingle(LeftSideHitResult, TraceStart, LeftSideTraceEnd, QueryParams, ObjectQueryParams);
 
 	if (LeftSideHit)
@@ -395,48 +705,39 @@ void ACharacterBase::Move(float AxisValue, EAxis::Type Axis)
 
 void ACharacterBase::LeftDash()
 {
-	this->Dash(-this->DashForce);
+	this->Dash(false);
 }
 
 void ACharacterBase::RightDash()
 {
-	this->Dash(this->DashForce);
+	this->Dash(true);
 }
 
-void ACharacterBase::Dash(float Force)
+void ACharacterBase::Dash(bool bRight)
 {
-	if (this->bIsDead)
-	{
-		return;
-	}
-
-	if (!this->UseEnergy(10.f))
+	if (this->bIsDead || (this->GetEnergy() < this->DashEnergy))
 	{
 		return;
 	}
 
-	if (Role < ROLE_Authority)
-	{
-		this->Dash_Server(Force);
-	}
-
-	// Find out which way is forward
-	const FRotator Rotation = this->GetController()->GetControlRotation();
-	const FRotator YawRotation(0.f, Rotation.Yaw, 0.f);
-
-	const FVector LaunchVelocity = YawRotation.RotateVector(FVector(0.f, Force, 50.f));
-
-	this->LaunchCharacter(LaunchVelocity, true, true);
+	// The dash is sent to the server with the saved moves, and the movement component performs it
+	UPacboyCharacterMovement* Movement = this->GetPacboyMovement();
+	Movement->bWantsToDash = true;
+	Movement->bDashRight = bRight;
 }
 
-bool ACharacterBase::Dash_Server_Validate(float Force)
+FVector ACharacterBase::GetDashVelocity(bool bRight) const
 {
-	return true;
+	// The actor follows the controller's yaw, which the server sets from the move before performing it
+	const FRotator YawRotation(0.f, this->GetActorRotation().Yaw, 0.f);
+	const float Force = bRight ? this->DashForce : -this->DashForce;
+
+	return YawRotation.RotateVector(FVector(0.f, Force, 50.f));
 }
 
-void ACharacterBase::Dash_Server_Implementation(float Force)
+UPacboyCharacterMovement* ACharacterBase::GetPacboyMovement() const
 {
-	this->Dash(Force);
+	return CastChecked<UPacboyCharacterMovement>(this->GetCharacterMovement());
 }
 
 void ACharacterBase::SprintStart()
@@ -446,52 +747,17 @@ void ACharacterBase::SprintStart()
 		return;
 	}
 
-	if (Role < ROLE_Authority)
-	{
-		this->SprintStart_Server();
-	}
+	// The movement component sends the input state to the server with the saved moves
+	this->GetPacboyMovement()->bWantsToSprint = true;
 
 	this->bIsSprinting = true;
-
-	if (!this->bIsAiming && !this->bIsReloading)
-	{
-		this->GetCharacterMovement()->MaxWalkSpeed = this->SprintSpeed;
-	}
-}
-
-bool ACharacterBase::SprintStart_Server_Validate()
-{
-	return true;
-}
-
-void ACharacterBase::SprintStart_Server_Implementation()
-{
-	this->SprintStart();
 }
 
 void ACharacterBase::SprintStop()
 {
-	if (Role < ROLE_Authority)
-	{
-		this->SprintStop_Server();
-	}
+	this->GetPacboyMovement()->bWantsToSprint = false;
 
 	this->bIsSprinting = false;
-
-	if (!this->bIsAiming)
-	{
-		this->GetCharacterMovement()->MaxWalkSpeed = this->JogSpeed;
-	}
-}
-
-bool ACharacterBase::SprintStop_Server_Validate()
-{
-	return true;
-}
-
-void ACharacterBase::SprintStop_Server_Implementation()
-{
-	this->SprintStop();
 }
 
 void ACharacterBase::AimStart()
@@ -501,202 +767,369 @@ void ACharacterBase::AimStart()
 		return;
 	}
 
-	if (Role < ROLE_Authority)
-	{
-		this->AimStart_Server();
-	}
+	this->GetPacboyMovement()->bWantsToAim = true;
 
 	this->bIsAiming = true;
 
 	this->bUseControllerRotationYaw = true; // While the character is aiming he must use the controller's yaw rotation
 	this->GetCharacterMovement()->bOrientRotationToMovement = false; // and he must not orient his rotation according to movement
-	this->GetCharacterMovement()->MaxWalkSpeed = this->AimSpeed;
 }
 
-bool ACharacterBase::AimStart_Server_Validate()
+void ACharacterBase::AimStop()
 {
-	return true;
+	this->GetPacboyMovement()->bWantsToAim = false;
+
+	this->bIsFiring = false;
+	this->bIsAiming = false;
+
+	//this->bUseControllerRotationYaw = false;
+	this->GetCharacterMovement()->bOrientRotationToMovement = true;
 }
 
-void ACharacterBase::AimStart_Server_Implementation()
+void ACharacterBase::FireStart_Key()
 {
-	this->AimStart();
+	this->FireStart();
 }
 
-void ACharacterBase::AimStop()
+void ACharacterBase::FireStart()
 {
-	if (Role < ROLE_Authority)
+	this->GetPacboyMovement()->bWantsToFire = true;
+
+	// The first shot is fired right away (the next ones by Tick)
+	if (this->IsLocallyControlled())
 	{
-		this->AimStop_Server();
+		this->UpdateFire();
 	}
+}
 
-	this->bIsFiring = false;
-	this->bIsAiming = false;
+bool ACharacterBase::CanFire() const
+{
+	return (this->EquippedWeapon != NULL) &&
+		!this->bIsDead &&
+		this->bIsAiming &&
+		!this->bIsReloading &&
+		(this->EquippedWeapon->AmmoInClip > 0);
+}
 
-	//this->bUseControllerRotationYaw = false;
-	this->GetCharacterMovement()->bOrientRotationToMovement = true;
-
-	if (this->bIsSprinting)
+void ACharacterBase::UpdateFire()
+{
+	AWeapon* Weapon = this->EquippedWeapon;
+	if (Weapon == NULL)
 	{
-		this->GetCharacterMovement()->MaxWalkSpeed = this->SprintSpeed;
+		return;
 	}
-	else
+
+	if (!this->GetPacboyMovement()->bWantsToFire || !this->CanFire())
 	{
-		this->GetCharacterMovement()->MaxWalkSpeed = this->JogSpeed;
+		// No shots are owed for the time the weapon couldn't fire
+		Weapon->FireScheduler.Disarm();
+		this->bIsFiring = false;
+		return;
 	}
-}
 
-bool ACharacterBase::AimStop_Server_Validate()
-{
-	return true;
-}
+	const float Time = this->GetWorld()->GetTimeSeconds();
+	const float ShotInterval = Weapon->GetShotInterval();
 
-void ACharacterBase::AimStop_Server_Implementation()
-{
-	this->AimStop();
-}
+	Weapon->FireScheduler.Arm(Time);
+	this->bIsFiring = true;
 
-void ACharacterBase::FireStart_Key()
-{
-	this->FireStart(false);
+	float FirstShotAge;
+	const int32 NumShots = Weapon->FireScheduler.Advance(Time, ShotInterval, FirstShotAge);
+
+	for (int32 i = 0; i < NumShots; i++)
+	{
+		// A shot may start the reload or swap the weapon
+		if (!this->bIsFiring || (this->EquippedWeapon != Weapon) || (Weapon->AmmoInClip <= 0))
+		{
+			break;
+		}
+
+		this->OnFire(FirstShotAge - i * ShotInterval);
+
+		INC_DWORD_STAT(STAT_ScheduledShots);
+	}
 }
 
-void ACharacterBase::FireStart(bool FromClient)
+void ACharacterBase::QueueCosmeticEvent(ECosmeticEventType::Type Type, const FVector& Location)
 {
 	if (Role < ROLE_Authority)
 	{
-		this->FireStart_Server(true);
+		FCosmeticEvent Event;
+		Event.Type = Type;
+		Event.Character = this;
+		Event.Location = Location;
+
+		ACosmeticEventRelay::PlayEvent(Event);
 		return;
 	}
 
-	this->FireFromClient = FromClient;
+	ACosmeticEventRelay* CosmeticEventRelay = ACosmeticEventRelay::Get(this->GetWorld());
+	if (CosmeticEventRelay != NULL)
+	{
+		CosmeticEventRelay->QueueEvent(Type, this, Location);
+	}
+}
 
-	this->ShootingGateOpen = true;
+void ACharacterBase::PlayFireFX(const FVector& Location)
+{
+	AFXPool* FXPool = AFXPool::Get(this->GetWorld());
 
-	if (!this->FirstShot)
+	if ((this->EquippedWeapon == NULL) || (FXPool == NULL))
 	{
-		if (this->DelayShot)
-		{
-			this->DelayShot = false;
-			return;
-		}
+		return;
 	}
 
-	if (!this->bIsReloading && this->bIsAiming &&
-		this->EquippedWeapon->AmmoInClip > 0.f)
-	{
-		this->bIsFiring = true;
-		this->OnFire();
+	const UWeaponDefinition* WeaponDefinition = this->EquippedWeapon->GetDefinition();
+
+	FXPool->SpawnAttached(WeaponDefinition->WeaponShotFX, this->EquippedWeapon->WeaponMesh, WeaponDefinition->GunMuzzleSocketName);
+	UGameplayStatics::PlaySoundAtLocation(this->GetWorld(), WeaponDefinition->WeaponShotSFX, Location);
+}
 
-		this->FirstShot = false;
+void ACharacterBase::PlayImpactFX(const FVector& ImpactPoint)
+{
+	AFXPool* FXPool = AFXPool::Get(this->GetWorld());
 
-		this->GetWorldTimerManager().SetTimer(this, &ACharacterBase::OnFire, 1.f / this->EquippedWeapon->ShotsPerSecond, true);
+	if ((this->EquippedWeapon == NULL) || (FXPool == NULL))
+	{
+		return;
 	}
+
+	FXPool->SpawnAtLocation(this->EquippedWeapon->GetDefinition()->WeaponImpactFX, ImpactPoint);
 }
 
-bool ACharacterBase::FireStart_Server_Validate(bool FromClient)
+void ACharacterBase::PlayHitFX(const FVector& ImpactPoint)
 {
-	return true;
+	AFXPool* FXPool = AFXPool::Get(this->GetWorld());
+
+	if (FXPool == NULL)
+	{
+		return;
+	}
+
+	FXPool->SpawnAtLocation(this->HitFX, ImpactPoint);
 }
 
-void ACharacterBase::FireStart_Server_Implementation(bool FromClient)
+void ACharacterBase::FireStop()
 {
-	this->FireStart(FromClient);
+	this->GetPacboyMovement()->bWantsToFire = false;
+
+	this->bIsFiring = false;
+
+	if (this->EquippedWeapon != NULL)
+	{
+		this->EquippedWeapon->FireScheduler.Disarm();
+	}
 }
 
-bool ACharacterBase::OnFireEvent_Multicast_Validate(FVector Location)
+void ACharacterBase::OnFire(float ShotAge)
 {
-	return true;
 }
 
-void ACharacterBase::OnFireEvent_Multicast_Implementation(FVector Location)
+void ACharacterBase::QueueFireCommand(const FVector& Origin, const FVector& Direction, float ShotAge, const FHitDescriptor* Hit)
 {
-	UGameplayStatics::SpawnEmitterAttached(this->EquippedWeapon->WeaponShotFX, this->EquippedWeapon->WeaponMesh, this->EquippedWeapon->GunMuzzleSocketName);
-	UGameplayStatics::PlaySoundAtLocation(this->GetWorld(), this->EquippedWeapon->WeaponShotSFX, Location);
+	FFireCommand Command;
+	Command.Origin = Origin;
+	Command.Direction = Direction;
+	Command.ClientTime = this->GetWorld()->GetTimeSeconds() - ShotAge;
+
+	if (Hit != NULL)
+	{
+		Command.bHasHit = true;
+		Command.Hit = *Hit;
+	}
+
+	this->PendingFireCommands.Add(Command);
+	this->NextFireSequence++;
 }
 
-void ACharacterBase::FireStop()
+void ACharacterBase::FlushFireCommands()
 {
-	if (Role < ROLE_Authority)
+	if ((this->PendingFireCommands.Num() == 0) && (this->LastSentFireCommands.Num() == 0))
 	{
-		this->FireStop_Server();
+		return;
 	}
 
-	this->bIsFiring = false;
-	this->DelayShot = true;
-	this->ShootingGateOpen = false;
+	const uint16 PendingFireSequence = this->NextFireSequence - this->PendingFireCommands.Num();
+
+	// The shots of the previous batch are sent again in case it was lost (the server drops duplicates)
+	FFireCommandBatch Batch;
+	Batch.FirstSequence = (this->LastSentFireCommands.Num() > 0) ? this->LastSentFireSequence : PendingFireSequence;
+	Batch.Commands.Append(this->LastSentFireCommands);
+	Batch.Commands.Append(this->PendingFireCommands);
+
+	// Drop the oldest shots if there are too many
+	const int32 Overflow = Batch.Commands.Num() - FFireCommandBatch::MaxCommands;
+	if (Overflow > 0)
+	{
+		Batch.Commands.RemoveAt(0, Overflow);
+		Batch.FirstSequence += Overflow;
+	}
+
+	this->FireCommands_Server(Batch);
+
+	this->LastSentFireSequence = PendingFireSequence;
+	this->LastSentFireCommands = this->PendingFireCommands;
+	this->PendingFireCommands.Reset();
 }
 
-bool ACharacterBase::FireStop_Server_Validate()
+bool ACharacterBase::FireCommands_Server_Validate(const FFireCommandBatch& Batch)
 {
+	for (int32 i = 0; i < Batch.Commands.Num(); i++)
+	{
+		const FFireCommand& Command = Batch.Commands[i];
+
+		// Only a modified client sends times or directions that no shot can have
+		if (!FMath::IsFinite(Command.ClientTime) || !Command.Direction.IsNormalized())
+		{
+			return false;
+		}
+	}
+
 	return true;
 }
 
-void ACharacterBase::FireStop_Server_Implementation()
+void ACharacterBase::FireCommands_Server_Implementation(const FFireCommandBatch& Batch)
 {
-	this->FireStop();
-}
+	const float ServerTime = this->GetWorld()->GetTimeSeconds();
 
-void ACharacterBase::OnFire()
-{
-}
+	for (int32 i = 0; i < Batch.Commands.Num(); i++)
+	{
+		const uint16 Sequence = Batch.FirstSequence + i;
 
-bool ACharacterBase::OnFire_Server_Validate(FVector SpawnLocation, FRotator SpawnRotation, AController* Shooter)
-{
-	return true;
+		if (this->bHasProcessedFireCommand)
+		{
+			if (!FFireCommandBatch::IsSequenceNewer(Sequence, this->LastProcessedFireSequence))
+			{
+				INC_DWORD_STAT(STAT_FireCommandsDuplicated);
+				continue;
+			}
+
+			// Shots missing between the last processed one and this one were lost with their batches
+			const uint16 NumLost = Sequence - this->LastProcessedFireSequence - 1;
+			INC_DWORD_STAT_BY(STAT_FireCommandsLost, NumLost);
+		}
+
+		this->LastProcessedFireSequence = Sequence;
+		this->bHasProcessedFireCommand = true;
+
+		const FFireCommand& Command = Batch.Commands[i];
+
+		if (!this->CanFire())
+		{
+			INC_DWORD_STAT(STAT_FireCommandsRejected);
+			continue;
+		}
+
+		const float ShotInterval = this->EquippedWeapon->GetShotInterval();
+
+		// The server time bounds the fire rate, a burst is allowed for the shots bunched by the network or a client hitch
+		this->FireTokens = FMath::Min(this->FireTokens + (ServerTime - this->FireTokensTime) / ShotInterval, (float)FWeaponFireScheduler::MaxShotsPerAdvance);
+		this->FireTokensTime = ServerTime;
+
+		if (this->FireTokens < 1.f)
+		{
+			INC_DWORD_STAT(STAT_FireCommandsRejected);
+			continue;
+		}
+
+		// The client clock cannot run ahead of the server one, the latency may only drop by the lag compensation window
+		if (this->ClientClockOffset == MAX_FLT)
+		{
+			this->ClientClockOffset = ServerTime - Command.ClientTime;
+		}
+
+		const float ClientTime = FMath::Min(Command.ClientTime, ServerTime - this->ClientClockOffset + this->MaxLagCompensation);
+
+		// Shots fired faster than the weapon allows are ignored (with some tolerance for frame timing)
+		if ((ClientTime - this->LastProcessedFireTime) < (0.9f * ShotInterval))
+		{
+			INC_DWORD_STAT(STAT_FireCommandsRejected);
+			continue;
+		}
+
+		this->FireTokens -= 1.f;
+		this->LastProcessedFireTime = ClientTime;
+
+		INC_DWORD_STAT(STAT_FireCommandsProcessed);
+
+		this->OnFireCommand(Command);
+	}
 }
 
-void ACharacterBase::OnFire_Server_Implementation(FVector SpawnLocation, FRotator SpawnRotation, AController* Shooter)
+void ACharacterBase::OnFireCommand(const FFireCommand& Command)
 {
-	FActorSpawnParameters ProjSpawnParams;
-	ProjSpawnParams.bNoCollisionFail = true;
+	const UWeaponDefinition* WeaponDefinition = this->EquippedWeapon->GetDefinition();
 
-	AProjectileBase* SpawnedProjectile = this->GetWorld()->SpawnActor<AProjectileBase>(this->EquippedWeapon->ProjectileClass, SpawnLocation, SpawnRotation, ProjSpawnParams);
-	SpawnedProjectile->Shooter = Shooter;
+	// The owning client already played the effects of the shot (see ACosmeticEventRelay)
+	this->QueueCosmeticEvent(ECosmeticEventType::Muzzle, Command.Origin);
+
+	if (WeaponDefinition->ShootingType == EWeaponShootingType::Instant)
+	{
+		if (Command.bHasHit)
+		{
+			this->QueueCosmeticEvent(ECosmeticEventType::Impact, Command.Hit.ImpactPoint);
+
+			this->ConfirmHit(Command);
+		}
+		else
+		{
+			// A miss is only traced for its impact effect
+			FCollisionQueryParams QueryParams(FName(TEXT("ShotTrace")), true, this);
+
+			FHitResult HitResult;
+			if (this->GetWorld()->LineTraceSingle(HitResult, Command.Origin, Command.Origin + (Command.Direction * WeaponDefinition->Range), ECollisionChannel::ECC_Visibility, QueryParams))
+			{
+				this->QueueCosmeticEvent(ECosmeticEventType::Impact, HitResult.ImpactPoint);
+			}
+		}
+	}
+	else if (WeaponDefinition->ShootingType == EWeaponShootingType::Projectile)
+	{
+		// The shooter is the controller of this connection, never a client supplied one
+		this->SpawnProjectile(Command.Origin, Command.Direction.Rotation(), this->GetController());
+	}
+
+	// The client starts the reload itself when the clip is empty (see ReloadStart_Server)
+	this->EquippedWeapon->AmmoInClip--;
 }
 
-void ACharacterBase::OnFire_Client_Implementation()
+void ACharacterBase::SpawnProjectile(const FVector& SpawnLocation, const FRotator& SpawnRotation, AController* Shooter)
 {
-	this->EquippedWeapon->AmmoInClip--;
+	if ((this->EquippedWeapon == NULL) || (this->EquippedWeapon->GetDefinition()->ProjectileClass == NULL))
+	{
+		return;
+	}
+
+	AProjectilePool* ProjectilePool = AProjectilePool::Get(this->GetWorld());
+	if (ProjectilePool != NULL)
+	{
+		ProjectilePool->Acquire(this->EquippedWeapon->GetDefinition()->ProjectileClass, SpawnLocation, SpawnRotation, Shooter);
+	}
 }
 
-void ACharacterBase::Reload_Client_Implementation()
+bool ACharacterBase::CanReload() const
 {
-	this->ReloadStart();
-	this->bReloadClient = false;
+	return (this->EquippedWeapon != NULL) &&
+		(this->EquippedWeapon->AmmoInClip < this->EquippedWeapon->GetDefinition()->ClipCapacity) &&
+		(this->EquippedWeapon->RemainingAmmo > 0) &&
+		!this->bIsReloading;
 }
 
 void ACharacterBase::ReloadStart()
 {
-	if (this->bIsDead)
+	if (this->bIsDead || !this->CanReload())
 	{
 		return;
 	}
 
 	if (Role < ROLE_Authority)
 	{
+		// The shots fired before the reload must reach the server first
+		this->FlushFireCommands();
 		this->ReloadStart_Server();
-		return;
 	}
 
-	if ((this->EquippedWeapon != NULL) &&
-		(this->EquippedWeapon->AmmoInClip < this->EquippedWeapon->ClipCapacity) &&
-		(this->EquippedWeapon->RemainingAmmo > 0) &&
-		!this->bIsReloading)
-	{
-		this->bIsFiring = false;
-		this->bIsReloading = true;
-
-		if (this->ReloadAnimTimeRemaining <= 0.f)
-		{
-			this->OnReloadStart_Multicast();
-		}
-
-		if (!this->bIsAiming)
-		{
-			this->GetCharacterMovement()->MaxWalkSpeed = this->JogSpeed;
-		}
-	}
+	this->BeginReload();
 }
 
 bool ACharacterBase::ReloadStart_Server_Validate()
@@ -706,95 +1139,87 @@ bool ACharacterBase::ReloadStart_Server_Validate()
 
 void ACharacterBase::ReloadStart_Server_Implementation()
 {
-	this->ReloadStart();
+	if (!this->bIsDead && this->CanReload())
+	{
+		this->BeginReload();
+	}
+	else if (!this->bIsReloading && (this->EquippedWeapon != NULL))
+	{
+		// The client predicted a reload that the server won't do
+		this->ReloadCorrection_Client(this->EquippedWeapon->AmmoInClip, this->EquippedWeapon->RemainingAmmo);
+	}
 }
 
-bool ACharacterBase::OnReloadStart_Server_Validate()
+void ACharacterBase::ReloadCorrection_Client_Implementation(int32 AmmoInClip, int32 RemainingAmmo)
 {
-	return true;
-}
+	this->CancelReload();
 
-void ACharacterBase::OnReloadStart_Server_Implementation()
-{
-	if (this->ReloadAnimTimeRemaining <= 0.f)
+	if (this->EquippedWeapon != NULL)
 	{
-		this->OnReloadStart_Multicast();
+		this->EquippedWeapon->AmmoInClip = AmmoInClip;
+		this->EquippedWeapon->RemainingAmmo = RemainingAmmo;
 	}
 }
 
-void ACharacterBase::OnReloadStart_Multicast_Implementation()
-{
-	this->ReloadAnimTimeRemaining = this->PlayAnimMontage(this->ReloadAnim);
-}
-
-void ACharacterBase::ReloadStop()
+void ACharacterBase::BeginReload()
 {
-	this->bIsReloading = false;
+	this->bIsFiring = false;
+	this->bIsReloading = true;
+	this->GetPacboyMovement()->bIsReloading = true;
 
-	if (Role < ROLE_Authority)
+	// The reload animation doesn't move the hitboxes, so the dedicated servers don't play it
+	if (ShouldPlayCosmetics(this->GetWorld()))
 	{
-		this->ReloadStop_Server();
+		this->PlayAnimMontage(this->ReloadAnim);
 	}
 
-	if (this->bIsAiming)
-	{
-		this->GetCharacterMovement()->MaxWalkSpeed = this->AimSpeed;
-	}
-	else if (this->bIsSprinting)
+	// Taken from the montage asset so the server and the clients use the same duration
+	const float Duration = (this->ReloadAnim != NULL) ? (this->ReloadAnim->SequenceLength / this->ReloadAnim->RateScale) : 0.f;
+
+	if (Duration > 0.f)
 	{
-		this->GetCharacterMovement()->MaxWalkSpeed = this->SprintSpeed;
+		this->SetGameplayTimer(this->ReloadTimer, &ACharacterBase::Reload, Duration);
 	}
 	else
 	{
-		this->GetCharacterMovement()->MaxWalkSpeed = this->JogSpeed;
+		this->Reload();
 	}
 }
 
-bool ACharacterBase::ReloadStop_Server_Validate()
-{
-	return true;
-}
-
-void ACharacterBase::ReloadStop_Server_Implementation()
-{
-	this->ReloadStop();
-}
-
 void ACharacterBase::Reload()
 {
-	this->Reload_OnClient();
-}
+	this->ClearGameplayTimer(this->ReloadTimer);
+	this->StopAnimMontage(this->ReloadAnim);
 
-void ACharacterBase::Reload_OnClient_Implementation()
-{
 	if (this->EquippedWeapon != NULL)
 	{
 		this->EquippedWeapon->Reload();
-		this->ReloadStop();
 	}
 
-	this->Reload_Server();
+	this->bIsReloading = false;
+	this->GetPacboyMovement()->bIsReloading = false;
 }
 
-bool ACharacterBase::Reload_Server_Validate()
+void ACharacterBase::CancelReload()
 {
-	return true;
+	this->ClearGameplayTimer(this->ReloadTimer);
+	this->StopAnimMontage(this->ReloadAnim);
+
+	this->bIsReloading = false;
+	this->GetPacboyMovement()->bIsReloading = false;
 }
 
-void ACharacterBase::Reload_Server_Implementation()
+void ACharacterBase::RespawnPlayer()
 {
-	if (this->EquippedWeapon != NULL)
+	if (Role < ROLE_Authority)
 	{
-		this->EquippedWeapon->Reload();
-		this->ReloadStop();
+		return;
 	}
-}
 
-void ACharacterBase::Respawn_Player_Client_Implementation()
-{
-	if (Role < ROLE_Authority)
+	APacboyGameMode* GameMode = Cast<APacboyGameMode>(this->GetWorld()->GetAuthGameMode());
+	if ((GameMode != NULL) && GameMode->RecycleCharacter(this))
 	{
-		this->Respawn_Player_Server();
+		return;
 	}
 
 	AMainPlayerController* ThisController = Cast<AMainPlayerController>(this->GetController());
@@ -803,27 +1228,93 @@ void ACharacterBase::Respawn_Player_Client_Implementation()
 
 	if (ThisController != NULL)
 	{
-		//ThisController->Respawn();
 		ThisController->ServerRestartPlayer();
 	}
 }
 
-bool ACharacterBase::Respawn_Player_Server_Validate()
+bool ACharacterBase::Recycle(const FVector& Location, const FRotator& Rotation)
 {
+	if ((Role < ROLE_Authority) || !this->bIsDead || this->IsPendingKill())
+	{
+		return false;
+	}
+
+	if (!this->TeleportTo(Location, Rotation, false, true))
+	{
+		return false;
+	}
+
+	this->Respawn_Multicast(Location, Rotation);
+
+	INC_DWORD_STAT(STAT_CharactersRecycled);
+
 	return true;
 }
 
-void ACharacterBase::Respawn_Player_Server_Implementation()
+void ACharacterBase::Respawn_Multicast_Implementation(FVector_NetQuantize Location, FRotator Rotation)
 {
-	AMainPlayerController* ThisController = Cast<AMainPlayerController>(this->GetController());
+	// The server already moved the character (see Recycle)
+	if (Role < ROLE_Authority)
+	{
+		this->TeleportTo(Location, Rotation, false, true);
+	}
 
-	this->DetachFromControllerPendingDestroy();
+	this->ResetForRespawn();
+}
 
-	if (ThisController != NULL)
+void ACharacterBase::ResetForRespawn()
+{
+	// The death timers (the other timers are restarted by the reset)
+	AGameplayTimerService* TimerService = AGameplayTimerService::Get(this->GetWorld());
+	if (TimerService != NULL)
 	{
-		//ThisController->Respawn();
-		ThisController->ServerRestartPlayer();
+		TimerService->ClearAllTimers(this);
 	}
+
+	this->CancelReload();
+	this->FireStop();
+
+	this->bIsDead = false;
+	this->bIsSprinting = false;
+	this->bIsAiming = false;
+	this->JumpCount = 0;
+
+	UPacboyCharacterMovement* Movement = this->GetPacboyMovement();
+	Movement->bWantsToSprint = false;
+	Movement->bWantsToAim = false;
+	Movement->bWantsToFire = false;
+	Movement->bWantsToDash = false;
+
+	this->Health = this->HealthCapacity;
+	this->SetEnergy(this->EnergyCapacity);
+
+	// The same weapons are used again, with the ammo of a new weapon, and the rifle is equipped
+	AWeapon* Weapons[] = { this->Rifle, this->RocketLauncher };
+	for (AWeapon* Weapon : Weapons)
+	{
+		if (Weapon != NULL)
+		{
+			Weapon->Init();
+			Weapon->SetActorHiddenInGame(Weapon != this->Rifle);
+		}
+	}
+
+	this->EquippedWeapon = this->Rifle;
+
+	// Undo Destroy_Body and the death in TakeDamage
+	this->SetActorHiddenInGame(false);
+	this->SetActorEnableCollision(true);
+	this->GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
+
+	Movement->StopMovementImmediately();
+	Movement->SetMovementMode(MOVE_Walking);
+	Movement->MaxWalkSpeed = this->JogSpeed;
+
+	this->bUseControllerRotationYaw = true;
+	Movement->bOrientRotationToMovement = true;
+
+	// The poses before the respawn are somewhere else
+	this->LagCompensation->ClearHistory();
 }
 
 void ACharacterBase::Despawn_Actor_Implementation()
@@ -833,15 +1324,90 @@ void ACharacterBase::Despawn_Actor_Implementation()
 
 void ACharacterBase::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	if (this->Rifle != NULL)
+	ANetRelevancyGrid* RelevancyGrid = ANetRelevancyGrid::Get(this->GetWorld());
+	if (RelevancyGrid != NULL)
 	{
-		this->Rifle->Destroy();
+		RelevancyGrid->RemoveActor(this);
 	}
 
-	if (this->RocketLauncher != NULL)
+	ASignificanceManager* SignificanceManager = ASignificanceManager::Get(this->GetWorld());
+	if (SignificanceManager != NULL)
+	{
+		SignificanceManager->UnregisterCharacter(this);
+	}
+
+	AGameplayTimerService* TimerService = AGameplayTimerService::Get(this->GetWorld());
+	if (TimerService != NULL)
+	{
+		TimerService->ClearAllTimers(this);
+	}
+
+	if (EndPlayReason == EEndPlayReason::Destroyed)
+	{
+		INC_DWORD_STAT(STAT_CharactersDestroyed);
+		APacboyLoadReport::RecordActorDestroyed();
+	}
+
+	AWeapon* Weapons[] = { this->Rifle, this->RocketLauncher };
+	for (AWeapon* Weapon : Weapons)
+	{
+		if ((Weapon != NULL) && !Weapon->IsPendingKill())
+		{
+			Weapon->Destroy();
+
+			INC_DWORD_STAT(STAT_WeaponsDestroyed);
+			APacboyLoadReport::RecordActorDestroyed();
+		}
+	}
+}
+
+void ACharacterBase::ScheduleDeathTimers(bool bDestroyBody)
+{
+	AGameplayTimerService* TimerService = AGameplayTimerService::Get(this->GetWorld());
+	if (TimerService == NULL)
+	{
+		return;
+	}
+
+	// The timers of the living character don't matter anymore
+	TimerService->ClearAllTimers(this);
+
+	if (bDestroyBody)
+	{
+		TimerService->SetTimer(this, &ACharacterBase::Destroy_Body, 1.f);
+	}
+
+	TimerService->SetTimer(this, &ACharacterBase::RespawnPlayer, 5.f);
+	TimerService->SetTimer(this, &ACharacterBase::Despawn_Actor, 15.f);
+}
+
+void ACharacterBase::SetGameplayTimer(FGameplayTimerHandle& Handle, FGameplayTimerDelegate::TUObjectMethodDelegate<ACharacterBase>::FMethodPtr Method, float Delay)
+{
+	AGameplayTimerService* TimerService = AGameplayTimerService::Get(this->GetWorld());
+	if (TimerService == NULL)
 	{
-		this->RocketLauncher->Destroy();
+		Handle.Invalidate();
+		return;
 	}
+
+	TimerService->ClearTimer(Handle);
+	Handle = TimerService->SetTimer(this, Method, Delay);
+}
+
+void ACharacterBase::ClearGameplayTimer(FGameplayTimerHandle& Handle)
+{
+	if (!Handle.IsValid())
+	{
+		return;
+	}
+
+	AGameplayTimerService* TimerService = AGameplayTimerService::Get(this->GetWorld());
+	if (TimerService != NULL)
+	{
+		TimerService->ClearTimer(Handle);
+	}
+
+	Handle.Invalidate();
 }
 
 void ACharacterBase::FellOutOfWorld(const class UDamageType& dmgType)
@@ -852,13 +1418,9 @@ void ACharacterBase::FellOutOfWorld(const class UDamageType& dmgType)
 		return;
 	}
 
-	this->GetWorldTimerManager().PauseTimer(this, &ACharacterBase::UpdateEnergy);
-
 	this->bIsDead = true;
 	this->Health = 0;
-	this->Energy = 0;
-
-	this->FellOutOfWorld_StopEnergy();
+	this->SetEnergy(0.f);
 
 	AMainPlayerController* ThisController = Cast<AMainPlayerController>(this->GetController());
 
@@ -869,10 +1431,9 @@ void ACharacterBase::FellOutOfWorld(const class UDamageType& dmgType)
 
 	this->Destroy_Body();
 
-	this->GetWorldTimerManager().PauseTimer(this, &ACharacterBase::OnFire);
+	this->FireStop();
 
-	this->GetWorldTimerManager().SetTimer(this, &ACharacterBase::Respawn_Player_Client, 5.f, false);
-	this->GetWorldTimerManager().SetTimer(this, &ACharacterBase::Despawn_Actor, 15.f, false);
+	this->ScheduleDeathTimers(false);
 }
 
 bool ACharacterBase::FellOutOfWorld_Server_Validate(const class UDamageType* dmgType)
@@ -885,43 +1446,110 @@ void ACharacterBase::FellOutOfWorld_Server_Implementation(const class UDamageTyp
 	this->FellOutOfWorld(*dmgType);
 }
 
-void ACharacterBase::FellOutOfWorld_StopEnergy_Implementation()
-{
-	this->GetWorldTimerManager().PauseTimer(this, &ACharacterBase::UpdateEnergy);
-}
-
 void ACharacterBase::Destroy_Body_Implementation()
 {
-	this->Rifle->Destroy();
-	this->RocketLauncher->Destroy();
-	this->GetCapsuleComponent()->DestroyComponent();
-	this->GetMesh()->DestroyComponent();
+	// The body and the weapons are only hidden, they are used again if the character is recycled (see ResetForRespawn)
+	if (this->Rifle != NULL)
+	{
+		this->Rifle->SetActorHiddenInGame(true);
+	}
+
+	if (this->RocketLauncher != NULL)
+	{
+		this->RocketLauncher->SetActorHiddenInGame(true);
+	}
+
+	this->SetActorHiddenInGame(true);
+	this->SetActorEnableCollision(false);
+
+	this->GetCharacterMovement()->StopMovementImmediately();
+	this->GetCharacterMovement()->DisableMovement();
 }
 
 bool ACharacterBase::UseEnergy(float EnergyValue)
 {
-	if (this->Energy < EnergyValue)
+	const float CurrentEnergy = this->GetEnergy();
+
+	if (CurrentEnergy < EnergyValue)
 	{
 		return false;
 	}
 
-	this->Energy -= EnergyValue;
+	this->SetEnergy(CurrentEnergy - EnergyValue);
 
 	return true;
 }
 
-void ACharacterBase::UpdateEnergy()
+float ACharacterBase::GetEnergy() const
 {
+	const float Elapsed = this->GetWorld()->GetTimeSeconds() - this->EnergyTimestamp;
+
+	return FMath::Clamp(this->EnergyBase + (this->EnergyRate * Elapsed), 0.f, this->EnergyCapacity);
+}
+
+void ACharacterBase::SetEnergy(float NewEnergy)
+{
+	// The energy jumps (UseEnergy goes through here too), which the clients must notice even if
+	// the replicated energy base and rate end up the same. The rate changes are continuous
+	this->EnergyEpoch++;
+
+	this->ResetEnergy(FMath::Clamp(NewEnergy, 0.f, this->EnergyCapacity), this->EnergyRate);
+}
+
+float ACharacterBase::ComputeEnergyRate() const
+{
+	if (this->bIsDead)
+	{
+		return 0.f;
+	}
+
+	// Sprinting drains 1 energy and resting regenerates EnergyRegen every 0.1 secs
 	if (this->bIsSprinting && !this->bIsAiming && this->GetVelocity() != FVector(0, 0, 0))
 	{
-		this->Energy = FMath::Max(this->Energy - 1.f, 0.f);
+		return -1.f / 0.1f;
 	}
-	else
+
+	return this->EnergyRegen / 0.1f;
+}
+
+void ACharacterBase::UpdateEnergyRate()
+{
+	const float NewEnergyRate = this->ComputeEnergyRate();
+
+	if (NewEnergyRate != this->EnergyRate)
+	{
+		this->ResetEnergy(this->GetEnergy(), NewEnergyRate);
+	}
+}
+
+void ACharacterBase::ResetEnergy(float NewEnergyBase, float NewEnergyRate)
+{
+	this->EnergyBase = NewEnergyBase;
+	this->EnergyRate = NewEnergyRate;
+	this->EnergyTimestamp = this->GetWorld()->GetTimeSeconds();
+
+	this->Energy = NewEnergyBase;
+
+	this->ScheduleEnergyDepletion();
+}
+
+void ACharacterBase::ScheduleEnergyDepletion()
+{
+	if (!this->bIsSprinting || (this->EnergyRate >= 0.f))
 	{
-		this->Energy = FMath::Min(this->Energy + this->EnergyRegen, this->EnergyCapacity);
+		this->ClearGameplayTimer(this->EnergyDepletionTimer);
+		return;
 	}
 
-	if (this->Energy <= 1.f && this->bIsSprinting)
+	// The sprint stops at 1 energy
+	const float TimeToDepletion = (this->EnergyBase - 1.f) / -this->EnergyRate;
+
+	this->SetGameplayTimer(this->EnergyDepletionTimer, &ACharacterBase::OnEnergyDepleted, FMath::Max(TimeToDepletion, KINDA_SMALL_NUMBER));
+}
+
+void ACharacterBase::OnEnergyDepleted()
+{
+	if (this->bIsSprinting)
 	{
 		this->SprintStop();
 	}
@@ -929,86 +1557,196 @@ void ACharacterBase::UpdateEnergy()
 
 void ACharacterBase::TakeDamage(float Damage, const FHitResult& Hit, AController* EventInstigator)
 {
+	// Only the server applies damage (the owning clients report their hits with their fire commands)
 	if (Role < ROLE_Authority)
 	{
-		this->TakeDamage_Server(Damage, Hit, EventInstigator);
 		return;
 	}
 
-	this->Health -= Damage;
+	ADamageQueue* DamageQueue = ADamageQueue::Get(this->GetWorld());
+	if (DamageQueue != NULL)
+	{
+		DamageQueue->QueueDamage(this, Damage, Hit, EventInstigator);
+	}
+	else
+	{
+		TArray<FQueuedHit> Hits;
+		Hits.Add(FQueuedHit(Damage, Hit, EventInstigator));
 
-	this->TakeDamageFX_Multicast(Hit.ImpactPoint);
+		this->ApplyQueuedDamage(Hits);
+	}
+}
 
-	if (this->bIsDead)
+void ACharacterBase::ApplyQueuedDamage(const TArray<FQueuedHit>& Hits)
+{
+	if (Hits.Num() == 0)
 	{
 		return;
 	}
 
-	if (this->Health <= 0.f)
-	{
-		this->bIsSprinting = false;
-		this->bIsAiming = false;
-		this->bIsFiring = false;
-		this->bIsReloading = false;
-		this->bIsDead = true;
-
-		this->GetWorldTimerManager().PauseTimer(this, &ACharacterBase::UpdateEnergy);
+	AController* Killer = NULL;
+	bool bKilled = false;
 
-		this->Energy = 0;
+	for (const FQueuedHit& QueuedHit : Hits)
+	{
+		this->Health -= QueuedHit.Damage;
 
-		AMainPlayerController* ThisController = Cast<AMainPlayerController>(this->GetController());
-		if (ThisController != NULL)
+		// The first hit that takes the last of the health gets the kill
+		if (!this->bIsDead && !bKilled && (this->Health <= 0.f))
 		{
-			ThisController->Deaths++;
+			Killer = QueuedHit.EventInstigator.Get();
+			bKilled = true;
 		}
+	}
 
-		AMainPlayerController* ShooterController = Cast<AMainPlayerController>(EventInstigator);
-		if (ShooterController != NULL && this->GetController() != EventInstigator)
-		{
-			ShooterController->Kills++;
-		}
+	// One effect for all the hits of the frame, at the last impact
+	this->QueueCosmeticEvent(ECosmeticEventType::Hit, Hits.Last().Hit.ImpactPoint);
 
-		if (!this->GetCharacterMovement()->IsFalling())
-		{
-			this->GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		}
+	if (bKilled)
+	{
+		this->Die(Killer);
+	}
+}
 
-		this->GetWorldTimerManager().SetTimer(this, &ACharacterBase::Destroy_Body, 1.f, false);
-		this->GetWorldTimerManager().SetTimer(this, &ACharacterBase::Respawn_Player_Client, 5.f, false);
-		this->GetWorldTimerManager().SetTimer(this, &ACharacterBase::Despawn_Actor, 15.f, false);
+void ACharacterBase::Die(AController* EventInstigator)
+{
+	this->bIsSprinting = false;
+	this->bIsAiming = false;
+	this->bIsFiring = false;
+	this->CancelReload();
+	this->bIsDead = true;
+
+	UPacboyCharacterMovement* Movement = this->GetPacboyMovement();
+	Movement->bWantsToSprint = false;
+	Movement->bWantsToAim = false;
+	Movement->bWantsToFire = false;
 
-		//this->GetMesh()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	this->SetEnergy(0.f);
 
-		this->TakeDamage_Client();
+	AMainPlayerController* ThisController = Cast<AMainPlayerController>(this->GetController());
+	if (ThisController != NULL)
+	{
+		ThisController->Deaths++;
+	}
 
-		this->GetWorldTimerManager().PauseTimer(this, &ACharacterBase::OnFire);
+	AMainPlayerController* ShooterController = Cast<AMainPlayerController>(EventInstigator);
+	if (ShooterController != NULL && this->GetController() != EventInstigator)
+	{
+		ShooterController->Kills++;
+	}
 
-		this->bUseControllerRotationYaw = false;
-		this->GetCharacterMovement()->bOrientRotationToMovement = false;
+	if (!this->GetCharacterMovement()->IsFalling())
+	{
+		this->GetCapsuleComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
 	}
+
+	this->ScheduleDeathTimers(true);
+
+	//this->GetMesh()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+
+	this->TakeDamage_Client();
+
+	this->FireStop();
+
+	this->bUseControllerRotationYaw = false;
+	this->GetCharacterMovement()->bOrientRotationToMovement = false;
 }
 
-bool ACharacterBase::TakeDamage_Server_Validate(float Damage, const FHitResult& Hit, AController* EventInstigator)
+FHitDescriptor ACharacterBase::MakeHitDescriptor(const FHitResult& Hit) const
 {
-	return true;
+	EHitZone::Type HitZone = EHitZone::Body;
+
+	const ACharacterBase* HitCharacter = Cast<ACharacterBase>(Hit.GetActor());
+	if ((HitCharacter != NULL) && (Hit.BoneName != NAME_None) && (Hit.BoneName == HitCharacter->LagCompensation->HeadBoneName))
+	{
+		HitZone = EHitZone::Head;
+	}
+
+	// The hit is sent with the next queued shot
+	return FHitDescriptor(Hit, HitZone, this->NextFireSequence);
 }
 
-void ACharacterBase::TakeDamage_Server_Implementation(float Damage, const FHitResult& Hit, AController* EventInstigator)
+void ACharacterBase::ConfirmHit(const FFireCommand& Command)
 {
-	this->TakeDamage(Damage, Hit, EventInstigator);
+	// The impact point may be off the shot by its quantization (see FFireCommand and FHitDescriptor)
+	const float MaxShotDeviation = 20.f;
+
+	const FHitDescriptor& Hit = Command.Hit;
+
+	// Only the hits of the accepted shots get here (see FireCommands_Server), so every hit is confirmed once
+	if ((Hit.Target == NULL) || (Hit.Target == this))
+	{
+		return;
+	}
+
+	// The impact must be on the shot the client fired, within the range of the weapon
+	const float Range = this->EquippedWeapon->GetDefinition()->Range;
+	const FVector ShotEnd = Command.Origin + (Command.Direction * Range);
+
+	if ((FVector::Dist(Command.Origin, Hit.ImpactPoint) > Range) ||
+		(FMath::PointDistToSegment(Hit.ImpactPoint, Command.Origin, ShotEnd) > MaxShotDeviation))
+	{
+		INC_DWORD_STAT(STAT_HitsRejected);
+		return;
+	}
+
+	// The walls don't move, so the impact point seen by the shooter is checked against the current static world
+	FCollisionQueryParams QueryParams(FName(TEXT("ConfirmHitTrace")), false, this);
+	QueryParams.AddIgnoredActor(Hit.Target);
+
+	if (this->GetWorld()->LineTraceTest(this->GetPawnViewLocation(), Hit.ImpactPoint, QueryParams, FCollisionObjectQueryParams(FCollisionObjectQueryParams::InitType::AllStaticObjects)))
+	{
+		INC_DWORD_STAT(STAT_HitsRejected);
+		return;
+	}
+
+	// The shot is checked from the view point of the shooter on the server, through the reported impact point
+	FHitResult HitResult = Hit.ToHitResult(this->GetPawnViewLocation());
+
+	AActor* HitActor = HitResult.GetActor();
+
+	IDamageableObject* DamageableObject = Cast<IDamageableObject>(HitActor);
+	if (DamageableObject == NULL)
+	{
+		return;
+	}
+
+	// Characters move, so the hit is checked against the pose the shooter saw
+	ACharacterBase* HitCharacter = Cast<ACharacterBase>(HitActor);
+	if (HitCharacter != NULL)
+	{
+		if (!HitCharacter->LagCompensation->DoesShotHitAtTime(this->GetLagCompensatedTime(), HitResult.TraceStart, HitResult.TraceEnd))
+		{
+			INC_DWORD_STAT(STAT_HitsRejected);
+			return;
+		}
+
+		if (Hit.HitZone == EHitZone::Head)
+		{
+			HitResult.BoneName = HitCharacter->LagCompensation->HeadBoneName;
+		}
+	}
+
+	DamageableObject->TakeDamage(this->EquippedWeapon->GetDefinition()->Damage, HitResult, this->GetController());
 }
 
-void ACharacterBase::TakeDamageFX_Multicast_Implementation(FVector ImpactPoint)
+float ACharacterBase::GetLagCompensatedTime() const
 {
-	UGameplayStatics::SpawnEmitterAtLocation(this->GetWorld(), this->HitFX, ImpactPoint);
+	float Latency = 0.f;
+
+	if (this->PlayerState != NULL)
+	{
+		Latency = FMath::Clamp(this->PlayerState->ExactPing * 0.001f, 0.f, this->MaxLagCompensation);
+	}
+
+	return this->GetWorld()->GetTimeSeconds() - Latency;
 }
 
 void ACharacterBase::TakeDamage_Client_Implementation()
 {
 	this->bUseControllerRotationYaw = false;
 	this->GetCharacterMovement()->bOrientRotationToMovement = false;
-	this->GetWorldTimerManager().PauseTimer(this, &ACharacterBase::OnFire);
-	this->GetWorldTimerManager().PauseTimer(this, &ACharacterBase::UpdateEnergy);
+	this->FireStop();
 }
 
 void ACharacterBase::ReceiveAnyDamage(float Damage, const class UDamageType* DamageType, class AController* InstigatedBy, AActor* DamageCauser)
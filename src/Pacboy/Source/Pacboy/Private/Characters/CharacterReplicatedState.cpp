@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Pacboy.h"
+#include "CharacterReplicatedState.h"
+#include "NetStats.h"
+
+const float FCharacterReplicatedState::QuantizeScale = 32.f;
+
+FCharacterReplicatedState::FCharacterReplicatedState()
+	: Flags(0)
+	, Health(0)
+	, EnergyBase(0)
+	, EnergyRate(0)
+	, EnergyEpoch(0)
+	, CharPitch(0)
+{
+}
+
+bool FCharacterReplicatedState::HasFlag(ECharacterStateFlags::Type Flag) const
+{
+	return (this->Flags & Flag) != 0;
+}
+
+void FCharacterReplicatedState::SetFlag(ECharacterStateFlags::Type Flag, bool bValue)
+{
+	if (bValue)
+	{
+		this->Flags |= Flag;
+	}
+	else
+	{
+		this->Flags &= ~Flag;
+	}
+}
+
+uint16 FCharacterReplicatedState::QuantizeValue(float Value)
+{
+	return (uint16)FMath::Clamp(FMath::RoundToInt(Value * QuantizeScale), 0, (int32)MAX_uint16);
+}
+
+float FCharacterReplicatedState::DequantizeValue(uint16 Value)
+{
+	return Value / QuantizeScale;
+}
+
+int16 FCharacterReplicatedState::QuantizeRate(float Rate)
+{
+	return (int16)FMath::Clamp(FMath::RoundToInt(Rate * QuantizeScale), (int32)MIN_int16, (int32)MAX_int16);
+}
+
+float FCharacterReplicatedState::DequantizeRate(int16 Rate)
+{
+	return Rate / QuantizeScale;
+}
+
+bool FCharacterReplicatedState::NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+{
+	Ar.SerializeBits(&this->Flags, ECharacterStateFlags::NumBits);
+
+	if (Ar.IsLoading())
+	{
+		this->Flags &= (1 << ECharacterStateFlags::NumBits) - 1;
+	}
+
+	Ar << this->Health;
+	Ar << this->EnergyBase;
+	Ar << this->EnergyRate;
+	Ar << this->EnergyEpoch;
+	Ar << this->CharPitch;
+
+#if PACBOY_NET_STATS
+	if (Ar.IsSaving() && FNetStats::IsEnabled())
+	{
+		const int64 Bits = ECharacterStateFlags::NumBits + 8 * (sizeof(this->Health) + sizeof(this->EnergyBase) + sizeof(this->EnergyRate) + sizeof(this->EnergyEpoch) + sizeof(this->CharPitch));
+		FNetStats::RecordProperty(Map, TEXT("ReplicatedState"), Bits);
+	}
+#endif
+
+	bOutSuccess = true;
+	return true;
+}
+
+bool FCharacterReplicatedState::operator==(const FCharacterReplicatedState& Other) const
+{
+	return (this->Flags == Other.Flags) &&
+		(this->Health == Other.Health) &&
+		(this->EnergyBase == Other.EnergyBase) &&
+		(this->EnergyRate == Other.EnergyRate) &&
+		(this->EnergyEpoch == Other.EnergyEpoch) &&
+		(this->CharPitch == Other.CharPitch);
+}
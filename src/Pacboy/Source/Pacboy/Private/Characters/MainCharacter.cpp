@@ -25,6 +25,10 @@ AMainCharacter::AMainCharacter(const FObjectInitializer& ObjectInitializer)
 	this->FollowCamera->bUsePawnControlRotation = false; // Already uses pawn control rotation, because it is attached to CameraBoom
 	this->FollowCamera->SetWorldRotation(FRotator::ZeroRotator);
 
+	// Create the component that moves the camera booms while aiming
+	this->AimCamera = ObjectInitializer.CreateDefaultSubobject<UAimCameraComponent>(this, FName(TEXT("AimCamera")));
+	this->AimCamera->SetCameraBooms(this->CameraBoom, this->CameraBoomExtension);
+
 	this->CameraBoomLengthCache = this->CameraBoom->TargetArmLength;
 	this->CameraBoomExtensionLengthCache = this->CameraBoomExtension->TargetArmLength;
 
@@ -34,6 +38,8 @@ AMainCharacter::AMainCharacter(const FObjectInitializer& ObjectInitializer)
 	this->CameraTransitionSmoothSpeed = 15.f; // The smooth speed at which the camera transitions between two points in space (A multiplier for DeltaTime)
 	this->MouseXSensitivity = 1.f;
 	this->MouseYSensitivity = 1.f;
+
+	this->bAimCameraAiming = false;
 }
 
 void AMainCharacter::BeginPlay()
@@ -41,52 +47,39 @@ void AMainCharacter::BeginPlay()
 	Super::BeginPlay();
 }
 
-void AMainCharacter::Tick(float DeltaTime)
+void AMainCharacter::AimStart()
 {
-	Super::Tick(DeltaTime);
+	Super::AimStart();
 
-	if (this->bIsAiming)
-	{
-		this->MoveCameraCloserToCharacter(this->CameraTransitionSmoothSpeed, DeltaTime);
-	}
-	else
-	{
-		this->MoveCameraFurtherFromCharacter(this->CameraTransitionSmoothSpeed, DeltaTime);
-	}
+	this->UpdateAimCamera();
 }
 
-void AMainCharacter::OnFire()
+void AMainCharacter::AimStop()
 {
-	if (this->EquippedWeapon != NULL &&
-		this->bIsAiming && !this->bIsReloading &&
-		this->EquippedWeapon->AmmoInClip > 0.f)
-	{
-		if (this->DelayShot)
-		{
-			this->DelayShot = false;
-			this->GetWorldTimerManager().PauseTimer(this, &ACharacterBase::OnFire);
+	Super::AimStop();
 
-			if (!this->FirstShot)
-			{
-				return;
-			}
-		}
+	this->UpdateAimCamera();
+}
 
-		if (this->FirstShot)
-		{
-			this->GetWorldTimerManager().SetTimer(this, &ACharacterBase::OnFire, 1.f / this->EquippedWeapon->ShotsPerSecond, true);
-		}
+void AMainCharacter::OnRep_ReplicatedState()
+{
+	Super::OnRep_ReplicatedState();
 
-		if (!this->ShootingGateOpen)
-		{
-			return;
-		}
+	// The server may change the aiming state (e.g. on death)
+	this->UpdateAimCamera();
+}
 
+void AMainCharacter::OnFire(float ShotAge)
+{
+	if (this->EquippedWeapon != NULL &&
+		this->bIsAiming && !this->bIsReloading &&
+		this->EquippedWeapon->AmmoInClip > 0.f)
+	{
 		UWorld* World = this->GetWorld();
 		if (World != NULL)
 		{
 			// Find the spawn location of the shot
-			FVector SpawnLocation = this->EquippedWeapon->WeaponMesh->GetSocketLocation(this->EquippedWeapon->GunMuzzleSocketName);
+			FVector SpawnLocation = this->EquippedWeapon->WeaponMesh->GetSocketLocation(this->EquippedWeapon->GetDefinition()->GunMuzzleSocketName);
 
 			// Find the spawn rotation of the shot
 			const FRotator CameraRotation = this->FollowCamera->GetComponentRotation();
@@ -95,7 +88,7 @@ void AMainCharacter::OnFire()
 			const FVector CameraForwardVector = FRotationMatrix(CameraRotation).GetUnitAxis(EAxis::X);
 
 			const FVector RayStart = CameraLocation;
-			const FVector RayEnd = RayStart + (CameraForwardVector * 10000.f);
+			const FVector RayEnd = RayStart + (CameraForwardVector * this->EquippedWeapon->GetDefinition()->Range);
 
 			FCollisionQueryParams QueryParams(FName(TEXT("ShotTrace")), true, this);
 			QueryParams.AddIgnoredActor(this);
@@ -104,6 +97,10 @@ void AMainCharacter::OnFire()
 
 			FVector ProjectileDirection;
 
+			// The hit of an instant shot is sent to the server with the shot
+			FHitDescriptor ShotHit;
+			bool bShotHit = false;
+
 			if (World->LineTraceSingle(HitResult, RayStart, RayEnd, ECollisionChannel::ECC_Camera, QueryParams))
 			{
 				ProjectileDirection = HitResult.Location - SpawnLocation; // If we hit something, we find more accurate shot direction
@@ -114,13 +111,12 @@ void AMainCharacter::OnFire()
 				ProjectileDirection = RayEnd - SpawnLocation; // The default shot direction is from the SpawnLocation to the RayEnd
 			}
 
-			this->OnFireEvent_Multicast(SpawnLocation);
+			this->QueueCosmeticEvent(ECosmeticEventType::Muzzle, SpawnLocation);
 
 			// TODO: refactor
-			if (this->EquippedWeapon->ShootingType == EWeaponShootingType::Instant)
+			if (this->EquippedWeapon->GetDefinition()->ShootingType == EWeaponShootingType::Instant)
 			{
-				FVector ImpactPoint = HitResult.ImpactPoint;
-				UGameplayStatics::SpawnEmitterAtLocation(this->GetWorld(), this->EquippedWeapon->WeaponImpactFX, ImpactPoint);
+				this->QueueCosmeticEvent(ECosmeticEventType::Impact, HitResult.ImpactPoint);
 
 				AActor* HitActor = HitResult.GetActor();
 				if (HitActor != NULL)
@@ -128,45 +124,54 @@ void AMainCharacter::OnFire()
 					IDamageableObject* DamageableObject = Cast<IDamageableObject>(HitActor);
 					if (DamageableObject != NULL)
 					{
-						DamageableObject->TakeDamage(this->EquippedWeapon->Damage, HitResult, this->GetController());
+						if (Role < ROLE_Authority)
+						{
+							// The server checks the hit before applying the damage
+							ShotHit = this->MakeHitDescriptor(HitResult);
+							bShotHit = true;
+						}
+						else
+						{
+							DamageableObject->TakeDamage(this->EquippedWeapon->GetDefinition()->Damage, HitResult, this->GetController());
+						}
 					}
 				}
 			}
-			else if (this->EquippedWeapon->ShootingType == EWeaponShootingType::Projectile)
+			else if (this->EquippedWeapon->GetDefinition()->ShootingType == EWeaponShootingType::Projectile)
 			{
 				const FRotator SpawnRotation = FRotationMatrix::MakeFromX(ProjectileDirection).Rotator();
 
-				if (Role < ROLE_Authority)
+				// A shot that was due earlier in the frame has already travelled part of its path
+				const TSubclassOf<AProjectileBase> ProjectileClass = this->EquippedWeapon->GetDefinition()->ProjectileClass;
+				const AProjectileBase* ProjectileDefaults = (ProjectileClass != NULL) ? ProjectileClass->GetDefaultObject<AProjectileBase>() : NULL;
+				if ((ShotAge > 0.f) && (ProjectileDefaults != NULL))
 				{
-					this->OnFire_Server(SpawnLocation, SpawnRotation, this->GetController());
+					const FVector ExtrapolatedLocation = SpawnLocation + SpawnRotation.Vector() * ProjectileDefaults->ProjectileMovement->InitialSpeed * ShotAge;
+
+					// It is not moved past the first obstacle (the projectile would miss it)
+					if (!World->LineTraceTest(SpawnLocation, ExtrapolatedLocation, ECollisionChannel::ECC_Visibility, QueryParams))
+					{
+						SpawnLocation = ExtrapolatedLocation;
+					}
 				}
-				else
-				{
-					FActorSpawnParameters ProjSpawnParams;
-					ProjSpawnParams.bNoCollisionFail = true;
 
-					AProjectileBase* SpawnedProjectile = this->GetWorld()->SpawnActor<AProjectileBase>(this->EquippedWeapon->ProjectileClass, SpawnLocation, SpawnRotation, ProjSpawnParams);
-					SpawnedProjectile->Shooter = this->GetController();
+				if (Role == ROLE_Authority)
+				{
+					this->SpawnProjectile(SpawnLocation, SpawnRotation, this->GetController());
 				}
 			}
 
+			if (Role < ROLE_Authority)
+			{
+				// The server fires the shot again (see FireCommands_Server)
+				this->QueueFireCommand(SpawnLocation, ProjectileDirection.SafeNormal(), ShotAge, bShotHit ? &ShotHit : NULL);
+			}
+
 			this->EquippedWeapon->AmmoInClip--;
 
 			if (this->EquippedWeapon->AmmoInClip <= 0.f && this->EquippedWeapon->RemainingAmmo > 0.f)
 			{
 				this->ReloadStart();
-				this->bReloadClient = true;
-			}
-
-			if (Role >= ROLE_Authority && this->FireFromClient)
-			{
-				this->OnFire_Client();
-
-				if (bReloadClient)
-				{
-					this->Reload_Client();
-					this->bReloadClient = false;
-				}
 			}
 		}
 	}
@@ -221,36 +226,21 @@ void AMainCharacter::ToggleCameraPosition()
 {
 }
 
-void AMainCharacter::MoveCameraCloserToCharacter(float TransitionSmoothSpeed, float DeltaTime)
+void AMainCharacter::UpdateAimCamera()
 {
-	if (FMath::Abs(this->CameraBoom->TargetArmLength - this->CameraBoomLengthWhileAiming) > 1.f)
+	if (this->bIsAiming == this->bAimCameraAiming)
 	{
-		// The camera must get closer to the character
-		this->CameraBoom->TargetArmLength =
-			FMath::Lerp(this->CameraBoom->TargetArmLength, this->CameraBoomLengthWhileAiming, TransitionSmoothSpeed * DeltaTime);
+		return;
 	}
 
-	if (FMath::Abs(this->CameraBoomExtension->TargetArmLength - this->CameraBoomExtensionLengthWhileAiming) > 1.f)
-	{
-		// The camera must be at this distance left of the target
-		this->CameraBoomExtension->TargetArmLength =
-			FMath::Lerp(this->CameraBoomExtension->TargetArmLength, this->CameraBoomExtensionLengthWhileAiming, TransitionSmoothSpeed * DeltaTime);
-	}
-}
+	this->bAimCameraAiming = this->bIsAiming;
 
-void AMainCharacter::MoveCameraFurtherFromCharacter(float TransitionSmoothSpeed, float DeltaTime)
-{
-	if (FMath::Abs(this->CameraBoom->TargetArmLength - this->CameraBoomLengthCache) > 1.f)
+	if (this->bIsAiming)
 	{
-		// The camera must get further away from the character
-		this->CameraBoom->TargetArmLength =
-			FMath::Lerp(this->CameraBoom->TargetArmLength, this->CameraBoomLengthCache, TransitionSmoothSpeed * DeltaTime);
+		this->AimCamera->MoveTo(this->CameraBoomLengthWhileAiming, this->CameraBoomExtensionLengthWhileAiming, this->CameraTransitionSmoothSpeed);
 	}
-
-	if (FMath::Abs(this->CameraBoomExtension->TargetArmLength - this->CameraBoomExtensionLengthCache) > 1.f)
+	else
 	{
-		// The camera must get closer to the right shoulder of the character
-		this->CameraBoomExtension->TargetArmLength =
-			FMath::Lerp(this->CameraBoomExtension->TargetArmLength, this->CameraBoomExtensionLengthCache, TransitionSmoothSpeed * DeltaTime);
+		this->AimCamera->MoveTo(this->CameraBoomLengthCache, this->CameraBoomExtensionLengthCache, this->CameraTransitionSmoothSpeed);
 	}
 }
\ No newline at end of file
@@ -0,0 +1,430 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Pacboy.h"
+#include "PacboyCharacterMovement.h"
+#include "CharacterBase.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Movement Corrections"), STAT_MovementCorrections, STATGROUP_Pacboy);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Wall Contacts Recorded Per Second"), STAT_WallContactsRecorded, STATGROUP_Pacboy);
+
+#if STATS
+
+/** The wall contacts recorded in the current second (read per second like the wall detection stats of ACharacterBase) */
+static uint32 WallContactsRecorded = 0;
+static float WallContactStatsTime = 0.f;
+
+/** Sets the wall contact stat to its rate once per second */
+static bool TickWallContactStats(float DeltaTime)
+{
+	WallContactStatsTime += DeltaTime;
+
+	if (WallContactStatsTime >= 1.f)
+	{
+		SET_DWORD_STAT(STAT_WallContactsRecorded, FMath::RoundToInt(WallContactsRecorded / WallContactStatsTime));
+
+		WallContactsRecorded = 0;
+		WallContactStatsTime = 0.f;
+	}
+
+	return true;
+}
+
+#endif
+
+/** Counts a recorded wall contact. The stat is ticked from the first one */
+static void CountWallContact()
+{
+#if STATS
+	static bool bIsTicking = false;
+
+	if (!bIsTicking)
+	{
+		FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&TickWallContactStats));
+		bIsTicking = true;
+	}
+
+	WallContactsRecorded++;
+#endif
+}
+
+/** A saved move with the sprint, aim and fire input states and the reload state */
+class FSavedMove_Pacboy : public FSavedMove_Character
+{
+public:
+
+	typedef FSavedMove_Character Super;
+
+	uint32 bSavedWantsToSprint : 1;
+
+	uint32 bSavedWantsToAim : 1;
+
+	uint32 bSavedWantsToFire : 1;
+
+	uint32 bSavedWantsToDash : 1;
+
+	uint32 bSavedDashRight : 1;
+
+	uint32 bSavedIsReloading : 1;
+
+	virtual void Clear() override
+	{
+		Super::Clear();
+
+		this->bSavedWantsToSprint = false;
+		this->bSavedWantsToAim = false;
+		this->bSavedWantsToFire = false;
+		this->bSavedWantsToDash = false;
+		this->bSavedDashRight = false;
+		this->bSavedIsReloading = false;
+	}
+
+	virtual uint8 GetCompressedFlags() const override
+	{
+		uint8 Flags = Super::GetCompressedFlags();
+
+		if (this->bSavedWantsToSprint)
+		{
+			Flags |= FLAG_Custom_0;
+		}
+
+		if (this->bSavedWantsToAim)
+		{
+			Flags |= FLAG_Custom_1;
+		}
+
+		if (this->bSavedWantsToFire)
+		{
+			Flags |= FLAG_Custom_2;
+		}
+
+		if (this->bSavedWantsToDash)
+		{
+			Flags |= FLAG_Custom_3;
+
+			if (this->bSavedDashRight)
+			{
+				Flags |= FLAG_Reserved_1;
+			}
+		}
+
+		if (this->bSavedIsReloading)
+		{
+			Flags |= FLAG_Reserved_2;
+		}
+
+		return Flags;
+	}
+
+	virtual bool CanCombineWith(const FSavedMovePtr& NewMove, ACharacter* Character, float MaxDelta) const override
+	{
+		const FSavedMove_Pacboy* NewPacboyMove = (const FSavedMove_Pacboy*)NewMove.Get();
+
+		// Every dash is performed by its own move
+		if (this->bSavedWantsToDash || NewPacboyMove->bSavedWantsToDash)
+		{
+			return false;
+		}
+
+		// The input and reload state changes must reach the server
+		if ((this->bSavedWantsToSprint != NewPacboyMove->bSavedWantsToSprint) ||
+			(this->bSavedWantsToAim != NewPacboyMove->bSavedWantsToAim) ||
+			(this->bSavedWantsToFire != NewPacboyMove->bSavedWantsToFire) ||
+			(this->bSavedIsReloading != NewPacboyMove->bSavedIsReloading))
+		{
+			return false;
+		}
+
+		return Super::CanCombineWith(NewMove, Character, MaxDelta);
+	}
+
+	virtual void SetMoveFor(ACharacter* Character, float InDeltaTime, FVector const& NewAccel, class FNetworkPredictionData_Client_Character& ClientData) override
+	{
+		Super::SetMoveFor(Character, InDeltaTime, NewAccel, ClientData);
+
+		const UPacboyCharacterMovement* Movement = Cast<UPacboyCharacterMovement>(Character->GetCharacterMovement());
+		if (Movement != NULL)
+		{
+			this->bSavedWantsToSprint = Movement->bWantsToSprint;
+			this->bSavedWantsToAim = Movement->bWantsToAim;
+			this->bSavedWantsToFire = Movement->bWantsToFire;
+			this->bSavedWantsToDash = Movement->bWantsToDash;
+			this->bSavedDashRight = Movement->bDashRight;
+			this->bSavedIsReloading = Movement->bIsReloading;
+		}
+	}
+};
+
+/** Allocates the Pacboy saved moves */
+class FNetworkPredictionData_Client_Pacboy : public FNetworkPredictionData_Client_Character
+{
+public:
+
+	virtual FSavedMovePtr AllocateNewMove() override
+	{
+		return FSavedMovePtr(new FSavedMove_Pacboy());
+	}
+};
+
+UPacboyCharacterMovement::UPacboyCharacterMovement(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	this->bWantsToSprint = false;
+	this->bWantsToAim = false;
+	this->bWantsToFire = false;
+	this->bWantsToDash = false;
+	this->bDashRight = false;
+	this->bIsReloading = false;
+	this->bSkipNetworkSmoothing = false;
+
+	this->WallContactMaxAge = 0.25f;
+	this->WallContactDistance = 100.f; // The length of the side traces of ACharacterBase::DetectWall
+
+	this->WallContactPoint = FVector::ZeroVector;
+	this->WallContactNormal = FVector::ZeroVector;
+	this->WallContactTime = -MAX_FLT;
+}
+
+float UPacboyCharacterMovement::GetMaxSpeed() const
+{
+	const ACharacterBase* Character = Cast<ACharacterBase>(this->CharacterOwner);
+
+	if ((Character == NULL) || !this->IsMovingOnGround())
+	{
+		return Super::GetMaxSpeed();
+	}
+
+	// Only the saved states are used, so the replayed moves get the same speed as the original ones
+	if (this->bWantsToAim)
+	{
+		return Character->AimSpeed;
+	}
+
+	if (this->bWantsToSprint && !this->bIsReloading)
+	{
+		return Character->SprintSpeed;
+	}
+
+	return Character->JogSpeed;
+}
+
+void UPacboyCharacterMovement::UpdateFromCompressedFlags(uint8 Flags)
+{
+	Super::UpdateFromCompressedFlags(Flags);
+
+	const bool bWasSprinting = this->bWantsToSprint;
+	const bool bWasAiming = this->bWantsToAim;
+	const bool bWasFiring = this->bWantsToFire;
+
+	this->bWantsToSprint = (Flags & FSavedMove_Character::FLAG_Custom_0) != 0;
+	this->bWantsToAim = (Flags & FSavedMove_Character::FLAG_Custom_1) != 0;
+	this->bWantsToFire = (Flags & FSavedMove_Character::FLAG_Custom_2) != 0;
+	this->bWantsToDash = (Flags & FSavedMove_Character::FLAG_Custom_3) != 0;
+	this->bDashRight = (Flags & FSavedMove_Character::FLAG_Reserved_1) != 0;
+
+	ACharacterBase* Character = Cast<ACharacterBase>(this->CharacterOwner);
+
+	// The client replays its moves with the flags too, but only the server applies the gameplay state changes
+	if ((Character == NULL) || (Character->Role < ROLE_Authority))
+	{
+		// The server keeps its own reload state, the flag only replays the moves with the state they were made in
+		this->bIsReloading = (Flags & FSavedMove_Character::FLAG_Reserved_2) != 0;
+		return;
+	}
+
+	// A sprint doesn't start without energy. While the client holds sprint, it starts once the energy is above 1 again
+	if (this->bWantsToSprint && !bWasSprinting && (Character->GetEnergy() <= 1.f))
+	{
+		this->bWantsToSprint = false;
+	}
+
+	if (this->bWantsToSprint != bWasSprinting)
+	{
+		if (this->bWantsToSprint)
+		{
+			Character->SprintStart();
+		}
+		else
+		{
+			Character->SprintStop();
+		}
+	}
+
+	if (this->bWantsToAim != bWasAiming)
+	{
+		if (this->bWantsToAim)
+		{
+			Character->AimStart();
+		}
+		else
+		{
+			Character->AimStop();
+		}
+	}
+
+	if (this->bWantsToFire != bWasFiring)
+	{
+		if (this->bWantsToFire)
+		{
+			Character->FireStart();
+		}
+		else
+		{
+			Character->FireStop();
+		}
+	}
+}
+
+bool UPacboyCharacterMovement::DoJump(bool bReplayingMoves)
+{
+	ACharacterBase* Character = Cast<ACharacterBase>(this->CharacterOwner);
+
+	if ((Character == NULL) || !this->IsFalling())
+	{
+		const bool bJumped = Super::DoJump(bReplayingMoves);
+
+		if (bJumped && (Character != NULL) && !bReplayingMoves)
+		{
+			Character->JumpCount++;
+		}
+
+		return bJumped;
+	}
+
+	FVector LaunchVelocity;
+	if (!Character->GetWallJumpVelocity(LaunchVelocity))
+	{
+		return false;
+	}
+
+	// Replayed moves were already charged when they were first performed
+	if (!bReplayingMoves)
+	{
+		if (!Character->UseEnergy(Character->WallJumpEnergy))
+		{
+			return false;
+		}
+
+		Character->JumpCount++;
+	}
+
+	this->Velocity = LaunchVelocity;
+	this->SetMovementMode(MOVE_Falling);
+
+	return true;
+}
+
+void UPacboyCharacterMovement::PerformMovement(float DeltaTime)
+{
+	if (this->bWantsToDash)
+	{
+		this->bWantsToDash = false;
+		this->PerformDash();
+	}
+
+	Super::PerformMovement(DeltaTime);
+}
+
+void UPacboyCharacterMovement::PerformDash()
+{
+	ACharacterBase* Character = Cast<ACharacterBase>(this->CharacterOwner);
+
+	if ((Character == NULL) || Character->bIsDead)
+	{
+		return;
+	}
+
+	// Replayed moves were already charged when they were first performed
+	if (!Character->bClientUpdating && !Character->UseEnergy(Character->DashEnergy))
+	{
+		return;
+	}
+
+	this->Velocity = Character->GetDashVelocity(this->bDashRight);
+	this->SetMovementMode(MOVE_Falling);
+}
+
+bool UPacboyCharacterMovement::FindWallContact(FVector& OutNormal) const
+{
+	if ((this->CharacterOwner == NULL) || (this->GetWorld()->GetTimeSeconds() - this->WallContactTime > this->WallContactMaxAge))
+	{
+		return false;
+	}
+
+	// Distance from the character to the plane of the wall
+	const float Distance = FVector::DotProduct(this->CharacterOwner->GetActorLocation() - this->WallContactPoint, this->WallContactNormal);
+
+	if (Distance > this->WallContactDistance)
+	{
+		return false;
+	}
+
+	OutNormal = this->WallContactNormal;
+
+	return true;
+}
+
+void UPacboyCharacterMovement::HandleImpact(FHitResult const& Hit, float TimeSlice, const FVector& MoveDelta)
+{
+	Super::HandleImpact(Hit, TimeSlice, MoveDelta);
+
+	const UPrimitiveComponent* HitComponent = Hit.GetComponent();
+
+	// Only the static and dynamic geometry can be used for the wall jumps (like the traces of ACharacterBase::DetectWall)
+	if (!Hit.bBlockingHit || (HitComponent == NULL) || this->IsWalkable(Hit))
+	{
+		return;
+	}
+
+	const ECollisionChannel ObjectType = HitComponent->GetCollisionObjectType();
+	if ((ObjectType != ECC_WorldStatic) && (ObjectType != ECC_WorldDynamic))
+	{
+		return;
+	}
+
+	this->WallContactPoint = Hit.ImpactPoint;
+	this->WallContactNormal = Hit.ImpactNormal;
+	this->WallContactTime = this->GetWorld()->GetTimeSeconds();
+
+	CountWallContact();
+}
+
+FNetworkPredictionData_Client* UPacboyCharacterMovement::GetPredictionData_Client() const
+{
+	check(this->PawnOwner != NULL);
+	check(this->PawnOwner->Role < ROLE_Authority);
+
+	if (this->ClientPredictionData == NULL)
+	{
+		UPacboyCharacterMovement* MutableThis = const_cast<UPacboyCharacterMovement*>(this);
+		MutableThis->ClientPredictionData = new FNetworkPredictionData_Client_Pacboy();
+	}
+
+	return this->ClientPredictionData;
+}
+
+void UPacboyCharacterMovement::SmoothCorrection(const FVector& OldLocation)
+{
+	if (this->bSkipNetworkSmoothing)
+	{
+		return;
+	}
+
+	Super::SmoothCorrection(OldLocation);
+}
+
+void UPacboyCharacterMovement::ClientUpdatePositionAfterServerUpdate()
+{
+	// The reload is not an input held every frame, the next moves must be saved with its current state
+	const bool bWasReloading = this->bIsReloading;
+
+	Super::ClientUpdatePositionAfterServerUpdate();
+
+	this->bIsReloading = bWasReloading;
+}
+
+void UPacboyCharacterMovement::ClientAdjustPosition_Implementation(float TimeStamp, FVector NewLoc, FVector NewVel, UPrimitiveComponent* NewBase, FName NewBaseBoneName, bool bHasBase, bool bBaseRelativePosition, uint8 ServerMovementMode)
+{
+	INC_DWORD_STAT(STAT_MovementCorrections);
+
+	Super::ClientAdjustPosition_Implementation(TimeStamp, NewLoc, NewVel, NewBase, NewBaseBoneName, bHasBase, bBaseRelativePosition, ServerMovementMode);
+}
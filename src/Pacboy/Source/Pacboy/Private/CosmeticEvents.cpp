@@ -0,0 +1,155 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Pacboy.h"
+#include "CosmeticEvents.h"
+#include "Characters/CharacterBase.h"
+#include "MainPlayerController.h"
+#include "WorldSingleton.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Cosmetic Events Queued"), STAT_CosmeticEventsQueued, STATGROUP_Pacboy);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Cosmetic Events Sent"), STAT_CosmeticEventsSent, STATGROUP_Pacboy);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Cosmetic Events Culled"), STAT_CosmeticEventsCulled, STATGROUP_Pacboy);
+
+ACosmeticEventRelay::ACosmeticEventRelay(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	this->PrimaryActorTick.bCanEverTick = true;
+
+	// Send the events once everything else in the frame has run
+	this->PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+
+	this->MaxEventDistance = 10000.f;
+	this->MaxEventsPerBundle = 64;
+}
+
+ACosmeticEventRelay* ACosmeticEventRelay::Get(UWorld* World)
+{
+	// The clients play their events right away (see ACharacterBase::QueueCosmeticEvent)
+	if ((World == NULL) || (World->GetNetMode() == NM_Client))
+	{
+		return NULL;
+	}
+
+	return GetWorldSingleton<ACosmeticEventRelay>(World);
+}
+
+void ACosmeticEventRelay::QueueEvent(ECosmeticEventType::Type Type, ACharacterBase* Character, const FVector& Location)
+{
+	FCosmeticEvent Event;
+	Event.Type = Type;
+	Event.Character = Character;
+	Event.Location = Location;
+
+	this->QueuedEvents.Add(Event);
+
+	INC_DWORD_STAT(STAT_CosmeticEventsQueued);
+}
+
+void ACosmeticEventRelay::PlayEvent(const FCosmeticEvent& Event)
+{
+	if (Event.Character == NULL)
+	{
+		return;
+	}
+
+	switch (Event.Type)
+	{
+	case ECosmeticEventType::Muzzle:
+		Event.Character->PlayFireFX(Event.Location);
+		break;
+	case ECosmeticEventType::Impact:
+		Event.Character->PlayImpactFX(Event.Location);
+		break;
+	case ECosmeticEventType::Hit:
+		Event.Character->PlayHitFX(Event.Location);
+		break;
+	}
+}
+
+void ACosmeticEventRelay::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	if (this->QueuedEvents.Num() == 0)
+	{
+		return;
+	}
+
+	TArray<FCosmeticEvent> Bundle;
+
+	for (FConstPlayerControllerIterator It = this->GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PlayerController = *It;
+		if (PlayerController == NULL)
+		{
+			continue;
+		}
+
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+		Bundle.Reset();
+
+		for (const FCosmeticEvent& Event : this->QueuedEvents)
+		{
+			if ((Bundle.Num() < this->MaxEventsPerBundle) && this->IsEventRelevantFor(Event, PlayerController, ViewLocation))
+			{
+				Bundle.Add(Event);
+			}
+			else
+			{
+				INC_DWORD_STAT(STAT_CosmeticEventsCulled);
+			}
+		}
+
+		if (Bundle.Num() == 0)
+		{
+			continue;
+		}
+
+		if (PlayerController->IsLocalController())
+		{
+			// Listen server or standalone player
+			for (const FCosmeticEvent& Event : Bundle)
+			{
+				ACosmeticEventRelay::PlayEvent(Event);
+			}
+		}
+		else
+		{
+			AMainPlayerController* MainPlayerController = Cast<AMainPlayerController>(PlayerController);
+			if (MainPlayerController != NULL)
+			{
+				MainPlayerController->PlayCosmeticEvents_Client(Bundle);
+				INC_DWORD_STAT_BY(STAT_CosmeticEventsSent, Bundle.Num());
+			}
+		}
+	}
+
+	this->QueuedEvents.Reset();
+}
+
+bool ACosmeticEventRelay::IsEventRelevantFor(const FCosmeticEvent& Event, APlayerController* PlayerController, const FVector& ViewLocation) const
+{
+	if (Event.Character == NULL)
+	{
+		return false;
+	}
+
+	// Remote players already played the effects of their own shots locally
+	if (Event.Type != ECosmeticEventType::Hit &&
+		!PlayerController->IsLocalController() &&
+		Event.Character->GetController() == PlayerController)
+	{
+		return false;
+	}
+
+	if (FVector::DistSquared(ViewLocation, Event.Location) > FMath::Square(this->MaxEventDistance))
+	{
+		return false;
+	}
+
+	// The character must exist on the client to play its effects
+	return Event.Character->IsNetRelevantFor(PlayerController, PlayerController->GetViewTarget(), ViewLocation);
+}
@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Pacboy.h"
+#include "DamageQueue.h"
+#include "WorldSingleton.h"
+
+DECLARE_CYCLE_STAT(TEXT("Damage Queue Flush"), STAT_DamageQueueFlush, STATGROUP_Pacboy);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damage Hits Queued"), STAT_DamageHitsQueued, STATGROUP_Pacboy);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damage Hits Merged"), STAT_DamageHitsMerged, STATGROUP_Pacboy);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Damage Targets"), STAT_DamageTargets, STATGROUP_Pacboy);
+
+ADamageQueue::ADamageQueue(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	this->PrimaryActorTick.bCanEverTick = true;
+
+	// Apply the hits once the projectiles have moved, and before the cosmetic events of the frame are sent
+	this->PrimaryActorTick.TickGroup = TG_PostPhysics;
+}
+
+ADamageQueue* ADamageQueue::Get(UWorld* World)
+{
+	// Only the server applies damage
+	if ((World == NULL) || (World->GetNetMode() == NM_Client))
+	{
+		return NULL;
+	}
+
+	return GetWorldSingleton<ADamageQueue>(World);
+}
+
+void ADamageQueue::QueueDamage(UObject* Target, float Damage, const FHitResult& Hit, AController* EventInstigator)
+{
+	if (Target == NULL)
+	{
+		return;
+	}
+
+	INC_DWORD_STAT(STAT_DamageHitsQueued);
+
+	const int32* TargetIndex = this->TargetIndices.Find(Target);
+
+	if (TargetIndex != NULL)
+	{
+		this->Targets[*TargetIndex].Hits.Add(FQueuedHit(Damage, Hit, EventInstigator));
+
+		INC_DWORD_STAT(STAT_DamageHitsMerged);
+		return;
+	}
+
+	this->TargetIndices.Add(Target, this->Targets.Num());
+
+	FDamageTarget& DamageTarget = this->Targets[this->Targets.AddDefaulted()];
+	DamageTarget.Target = Target;
+	DamageTarget.Hits.Add(FQueuedHit(Damage, Hit, EventInstigator));
+}
+
+void ADamageQueue::Flush()
+{
+	if (this->Targets.Num() == 0)
+	{
+		return;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_DamageQueueFlush);
+
+	// The hits taken while these ones are applied wait for the next flush
+	TArray<FDamageTarget> FlushedTargets;
+	Exchange(FlushedTargets, this->Targets);
+	this->TargetIndices.Reset();
+
+	INC_DWORD_STAT_BY(STAT_DamageTargets, FlushedTargets.Num());
+
+	for (const FDamageTarget& DamageTarget : FlushedTargets)
+	{
+		IDamageableObject* DamageableObject = Cast<IDamageableObject>(DamageTarget.Target.Get());
+		if (DamageableObject != NULL)
+		{
+			DamageableObject->ApplyQueuedDamage(DamageTarget.Hits);
+		}
+	}
+}
+
+void ADamageQueue::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	this->Flush();
+}
+
+void ADamageQueue::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	this->Targets.Reset();
+	this->TargetIndices.Reset();
+}
@@ -0,0 +1,176 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Pacboy.h"
+#include "FXPool.h"
+#include "WorldSingleton.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("FX Pool Active Components"), STAT_FXPoolActive, STATGROUP_Pacboy);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("FX Pool Free Components"), STAT_FXPoolFree, STATGROUP_Pacboy);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("FX Pool Components Created"), STAT_FXPoolCreated, STATGROUP_Pacboy);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("FX Pool Steals"), STAT_FXPoolSteals, STATGROUP_Pacboy);
+
+AFXPool::AFXPool(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	this->MaxComponentsPerTemplate = 16;
+	this->ActiveCount = 0;
+	this->FreeCount = 0;
+}
+
+AFXPool* AFXPool::Get(UWorld* World)
+{
+	if (!ShouldPlayCosmetics(World))
+	{
+		return NULL;
+	}
+
+	return GetWorldSingleton<AFXPool>(World);
+}
+
+UParticleSystemComponent* AFXPool::SpawnAtLocation(UParticleSystem* Template, const FVector& Location, const FRotator& Rotation)
+{
+	if (Template == NULL)
+	{
+		return NULL;
+	}
+
+	UParticleSystemComponent* Component = this->AcquireComponent(this->FindOrAddBucket(Template));
+	if (Component == NULL)
+	{
+		return NULL;
+	}
+
+	Component->DetachFromParent();
+	Component->SetAbsolute(true, true, true);
+	Component->SetWorldLocationAndRotation(Location, Rotation);
+	Component->SetRelativeScale3D(FVector(1.f));
+	Component->ActivateSystem(true);
+
+	return Component;
+}
+
+UParticleSystemComponent* AFXPool::SpawnAttached(UParticleSystem* Template, USceneComponent* AttachToComponent, FName AttachPointName)
+{
+	if ((Template == NULL) || (AttachToComponent == NULL))
+	{
+		return NULL;
+	}
+
+	UParticleSystemComponent* Component = this->AcquireComponent(this->FindOrAddBucket(Template));
+	if (Component == NULL)
+	{
+		return NULL;
+	}
+
+	Component->SetAbsolute(false, false, false);
+	Component->AttachTo(AttachToComponent, AttachPointName);
+	Component->SetRelativeLocationAndRotation(FVector::ZeroVector, FRotator::ZeroRotator);
+	Component->SetRelativeScale3D(FVector(1.f));
+	Component->ActivateSystem(true);
+
+	return Component;
+}
+
+FFXPoolBucket& AFXPool::FindOrAddBucket(UParticleSystem* Template)
+{
+	for (FFXPoolBucket& Bucket : this->Buckets)
+	{
+		if (Bucket.Template == Template)
+		{
+			return Bucket;
+		}
+	}
+
+	const int32 Index = this->Buckets.AddDefaulted();
+	this->Buckets[Index].Template = Template;
+
+	return this->Buckets[Index];
+}
+
+UParticleSystemComponent* AFXPool::AcquireComponent(FFXPoolBucket& Bucket)
+{
+	UParticleSystemComponent* Component = NULL;
+
+	// Components destroyed from outside of the pool are skipped
+	while ((Component == NULL) && (Bucket.FreeComponents.Num() > 0))
+	{
+		Component = Bucket.FreeComponents.Pop(false);
+		this->FreeCount--;
+
+		if ((Component != NULL) && Component->IsPendingKill())
+		{
+			Component = NULL;
+		}
+	}
+
+	if ((Component == NULL) && (Bucket.ActiveComponents.Num() >= FMath::Max(this->MaxComponentsPerTemplate, 1)))
+	{
+		// Removed from the active components first, so the finished event of the forced stop doesn't put it in the pool
+		Component = Bucket.ActiveComponents[0];
+		Bucket.ActiveComponents.RemoveAt(0, 1, false);
+		this->ActiveCount--;
+
+		if ((Component != NULL) && !Component->IsPendingKill())
+		{
+			Component->KillParticlesForced();
+
+			INC_DWORD_STAT(STAT_FXPoolSteals);
+		}
+		else
+		{
+			Component = NULL;
+		}
+	}
+
+	if (Component == NULL)
+	{
+		Component = ConstructObject<UParticleSystemComponent>(UParticleSystemComponent::StaticClass(), this);
+		Component->bAutoDestroy = false;
+		Component->bAutoActivate = false;
+		Component->SecondsBeforeInactive = 0.f;
+		Component->SetTemplate(Bucket.Template);
+		Component->OnSystemFinished.AddDynamic(this, &AFXPool::OnComponentFinished);
+		Component->RegisterComponentWithWorld(this->GetWorld());
+
+		INC_DWORD_STAT(STAT_FXPoolCreated);
+	}
+
+	Bucket.ActiveComponents.Add(Component);
+	this->ActiveCount++;
+
+	this->UpdateStats();
+
+	return Component;
+}
+
+void AFXPool::OnComponentFinished(UParticleSystemComponent* Component)
+{
+	if (Component == NULL)
+	{
+		return;
+	}
+
+	FFXPoolBucket& Bucket = this->FindOrAddBucket(Component->Template);
+
+	// Stolen components are not in the active components anymore
+	if (Bucket.ActiveComponents.Remove(Component) == 0)
+	{
+		return;
+	}
+
+	// Don't keep following the weapon (which may be destroyed) while waiting in the pool
+	Component->DetachFromParent();
+
+	Bucket.FreeComponents.Add(Component);
+
+	this->ActiveCount--;
+	this->FreeCount++;
+
+	this->UpdateStats();
+}
+
+void AFXPool::UpdateStats()
+{
+	SET_DWORD_STAT(STAT_FXPoolActive, this->ActiveCount);
+	SET_DWORD_STAT(STAT_FXPoolFree, this->FreeCount);
+}
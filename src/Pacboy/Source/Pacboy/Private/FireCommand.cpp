@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Pacboy.h"
+#include "FireCommand.h"
+
+bool FFireCommandBatch::NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+{
+	Ar << this->FirstSequence;
+
+	uint32 NumCommands = FMath::Min(this->Commands.Num(), MaxCommands);
+	Ar.SerializeInt(NumCommands, MaxCommands + 1);
+
+	if (Ar.IsLoading())
+	{
+		this->Commands.SetNum(NumCommands);
+	}
+
+	if (NumCommands == 0)
+	{
+		bOutSuccess = true;
+		return true;
+	}
+
+	// The time of the first shot is sent in full, the others as milliseconds after it
+	float BaseClientTime = this->Commands[0].ClientTime;
+	Ar << BaseClientTime;
+
+	bOutSuccess = true;
+
+	for (uint32 i = 0; i < NumCommands; i++)
+	{
+		FFireCommand& Command = this->Commands[i];
+
+		bool bSuccess = true;
+		Command.Origin.NetSerialize(Ar, Map, bSuccess);
+		bOutSuccess &= bSuccess;
+
+		Command.Direction.NetSerialize(Ar, Map, bSuccess);
+		bOutSuccess &= bSuccess;
+
+		uint16 TimeOffset = (uint16)FMath::Clamp(FMath::RoundToInt((Command.ClientTime - BaseClientTime) * 1000.f), 0, (int32)MAX_uint16);
+		Ar << TimeOffset;
+
+		if (Ar.IsLoading())
+		{
+			Command.ClientTime = BaseClientTime + (TimeOffset * 0.001f);
+		}
+
+		// Most shots miss, so the hit costs a single bit when there is none
+		uint8 bHasHit = Command.bHasHit ? 1 : 0;
+		Ar.SerializeBits(&bHasHit, 1);
+		Command.bHasHit = (bHasHit != 0);
+
+		if (Command.bHasHit)
+		{
+			Command.Hit.NetSerialize(Ar, Map, bSuccess);
+			bOutSuccess &= bSuccess;
+
+			// The hit belongs to the shot that carries it
+			Command.Hit.ShotSequence = this->FirstSequence + i;
+		}
+	}
+
+	return true;
+}
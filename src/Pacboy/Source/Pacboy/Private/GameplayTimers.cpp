@@ -0,0 +1,485 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Pacboy.h"
+#include "GameplayTimers.h"
+#include "WorldSingleton.h"
+
+DECLARE_CYCLE_STAT(TEXT("Gameplay Timers Advance"), STAT_GameplayTimersAdvance, STATGROUP_Pacboy);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Gameplay Timers"), STAT_GameplayTimers, STATGROUP_Pacboy);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Gameplay Timers Fired"), STAT_GameplayTimersFired, STATGROUP_Pacboy);
+
+FGameplayTimerWheel::FGameplayTimerWheel(float InTickResolution)
+	: TickResolution(FMath::Max(InTickResolution, KINDA_SMALL_NUMBER))
+	, TimeSinceTick(0.f)
+	, CurrentTick(0)
+	, FirstFree(INDEX_NONE)
+	, NumTimers(0)
+{
+	for (int32 i = 0; i < ARRAY_COUNT(this->ListHeads); i++)
+	{
+		this->ListHeads[i] = INDEX_NONE;
+	}
+}
+
+FGameplayTimerHandle FGameplayTimerWheel::Schedule(const UObject* Owner, float Delay, const FGameplayTimerDelegate& Delegate)
+{
+	FGameplayTimerHandle Handle;
+
+	if (!Delegate.IsBound())
+	{
+		return Handle;
+	}
+
+	int32 Index = this->FirstFree;
+	if (Index != INDEX_NONE)
+	{
+		this->FirstFree = this->Timers[Index].Next;
+	}
+	else
+	{
+		Index = this->Timers.AddDefaulted();
+		this->Timers[Index].Serial = 0;
+	}
+
+	// The timer fires on the first tick at or after the requested time
+	const double TimeFromTick = (double)this->TimeSinceTick + FMath::Max(Delay, 0.f);
+	uint64 Ticks = (uint64)FMath::Clamp(TimeFromTick / this->TickResolution, 1.0, 1e12);
+	if ((double)Ticks * this->TickResolution < TimeFromTick)
+	{
+		Ticks++;
+	}
+
+	FTimer& Timer = this->Timers[Index];
+	Timer.Delegate = Delegate;
+	Timer.Owner = Owner;
+	Timer.ExpireTick = this->CurrentTick + Ticks;
+	Timer.Serial++;
+	Timer.List = INDEX_NONE;
+	Timer.Prev = INDEX_NONE;
+	Timer.Next = INDEX_NONE;
+	Timer.OwnerPrev = INDEX_NONE;
+	Timer.OwnerNext = INDEX_NONE;
+
+	this->Insert(Index);
+	this->LinkToOwner(Index);
+
+	this->NumTimers++;
+
+	Handle.Index = Index;
+	Handle.Serial = Timer.Serial;
+
+	return Handle;
+}
+
+void FGameplayTimerWheel::Cancel(FGameplayTimerHandle& Handle)
+{
+	const int32 Index = this->Find(Handle);
+	if (Index != INDEX_NONE)
+	{
+		this->Release(Index);
+	}
+
+	Handle.Invalidate();
+}
+
+void FGameplayTimerWheel::CancelAll(const UObject* Owner)
+{
+	if (Owner == NULL)
+	{
+		return;
+	}
+
+	// Releasing the first timer of the owner moves the head to the next one (or removes it)
+	for (const int32* Head = this->OwnerHeads.Find(Owner); Head != NULL; Head = this->OwnerHeads.Find(Owner))
+	{
+		this->Release(*Head);
+	}
+}
+
+bool FGameplayTimerWheel::IsActive(const FGameplayTimerHandle& Handle) const
+{
+	return this->Find(Handle) != INDEX_NONE;
+}
+
+float FGameplayTimerWheel::GetTimeRemaining(const FGameplayTimerHandle& Handle) const
+{
+	const int32 Index = this->Find(Handle);
+	if (Index == INDEX_NONE)
+	{
+		return -1.f;
+	}
+
+	const uint64 ExpireTick = this->Timers[Index].ExpireTick;
+	const uint64 Ticks = (ExpireTick > this->CurrentTick) ? (ExpireTick - this->CurrentTick) : 0;
+
+	return FMath::Max((float)(Ticks * this->TickResolution) - this->TimeSinceTick, 0.f);
+}
+
+int32 FGameplayTimerWheel::Advance(float DeltaTime)
+{
+	this->TimeSinceTick += DeltaTime;
+
+	if (this->TimeSinceTick < this->TickResolution)
+	{
+		return 0;
+	}
+
+	const uint64 ElapsedTicks = (uint64)(this->TimeSinceTick / this->TickResolution);
+	this->TimeSinceTick -= ElapsedTicks * this->TickResolution;
+
+	// Nothing to fire or to move down the levels
+	if (this->NumTimers == 0)
+	{
+		this->CurrentTick += ElapsedTicks;
+		return 0;
+	}
+
+	int32 NumFired = 0;
+
+	for (uint64 i = 0; i < ElapsedTicks; i++)
+	{
+		NumFired += this->Step();
+	}
+
+	return NumFired;
+}
+
+int32 FGameplayTimerWheel::Step()
+{
+	this->CurrentTick++;
+
+	// Every full turn of a level moves the timers of the next slot of the level above down the wheel
+	for (int32 Level = 1; Level < NumLevels; Level++)
+	{
+		const int32 LevelShift = SlotBits * Level;
+
+		if ((this->CurrentTick & ((uint64(1) << LevelShift) - 1)) != 0)
+		{
+			break;
+		}
+
+		const int32 List = Level * NumSlots + (int32)((this->CurrentTick >> LevelShift) & (NumSlots - 1));
+
+		int32 Index = this->ListHeads[List];
+		this->ListHeads[List] = INDEX_NONE;
+
+		while (Index != INDEX_NONE)
+		{
+			const int32 Next = this->Timers[Index].Next;
+			this->Insert(Index);
+			Index = Next;
+		}
+	}
+
+	// The timers of the slot are moved to the pending list first, so the fired delegates can cancel any of them
+	const int32 Slot = (int32)(this->CurrentTick & (NumSlots - 1));
+
+	this->ListHeads[PendingList] = this->ListHeads[Slot];
+	this->ListHeads[Slot] = INDEX_NONE;
+
+	for (int32 Index = this->ListHeads[PendingList]; Index != INDEX_NONE; Index = this->Timers[Index].Next)
+	{
+		this->Timers[Index].List = PendingList;
+	}
+
+	int32 NumFired = 0;
+
+	while (this->ListHeads[PendingList] != INDEX_NONE)
+	{
+		const int32 Index = this->ListHeads[PendingList];
+
+		// Timers longer than the wheel go around again
+		if (this->Timers[Index].ExpireTick > this->CurrentTick)
+		{
+			this->UnlinkFromList(Index);
+			this->Insert(Index);
+			continue;
+		}
+
+		// Released before being executed, the delegate may schedule new timers in the same entry
+		const FGameplayTimerDelegate Delegate = this->Timers[Index].Delegate;
+		this->Release(Index);
+
+		Delegate.ExecuteIfBound();
+
+		NumFired++;
+	}
+
+	return NumFired;
+}
+
+void FGameplayTimerWheel::Insert(int32 Index)
+{
+	const uint64 ExpireTick = this->Timers[Index].ExpireTick;
+	const uint64 Delta = (ExpireTick > this->CurrentTick) ? (ExpireTick - this->CurrentTick) : 0;
+
+	int32 Level = 0;
+	while ((Level < NumLevels - 1) && (Delta >= (uint64(1) << (SlotBits * (Level + 1)))))
+	{
+		Level++;
+	}
+
+	// Beyond the last level, the timer waits in the furthest slot and is inserted again from there
+	uint64 SlotTick = ExpireTick;
+	if (Delta >= (uint64(1) << (SlotBits * NumLevels)))
+	{
+		SlotTick = this->CurrentTick + (uint64(1) << (SlotBits * NumLevels)) - 1;
+	}
+
+	const int32 List = Level * NumSlots + (int32)((SlotTick >> (SlotBits * Level)) & (NumSlots - 1));
+
+	this->LinkToList(Index, List);
+}
+
+void FGameplayTimerWheel::LinkToList(int32 Index, int32 List)
+{
+	FTimer& Timer = this->Timers[Index];
+
+	Timer.List = List;
+	Timer.Prev = INDEX_NONE;
+	Timer.Next = this->ListHeads[List];
+
+	if (Timer.Next != INDEX_NONE)
+	{
+		this->Timers[Timer.Next].Prev = Index;
+	}
+
+	this->ListHeads[List] = Index;
+}
+
+void FGameplayTimerWheel::UnlinkFromList(int32 Index)
+{
+	FTimer& Timer = this->Timers[Index];
+
+	if (Timer.Prev != INDEX_NONE)
+	{
+		this->Timers[Timer.Prev].Next = Timer.Next;
+	}
+	else
+	{
+		this->ListHeads[Timer.List] = Timer.Next;
+	}
+
+	if (Timer.Next != INDEX_NONE)
+	{
+		this->Timers[Timer.Next].Prev = Timer.Prev;
+	}
+
+	Timer.List = INDEX_NONE;
+	Timer.Prev = INDEX_NONE;
+	Timer.Next = INDEX_NONE;
+}
+
+void FGameplayTimerWheel::LinkToOwner(int32 Index)
+{
+	FTimer& Timer = this->Timers[Index];
+
+	if (Timer.Owner == NULL)
+	{
+		return;
+	}
+
+	// The owners are only in the map while they have timers
+	int32* Head = this->OwnerHeads.Find(Timer.Owner);
+
+	Timer.OwnerPrev = INDEX_NONE;
+
+	if (Head != NULL)
+	{
+		Timer.OwnerNext = *Head;
+		this->Timers[*Head].OwnerPrev = Index;
+		*Head = Index;
+	}
+	else
+	{
+		Timer.OwnerNext = INDEX_NONE;
+		this->OwnerHeads.Add(Timer.Owner, Index);
+	}
+}
+
+void FGameplayTimerWheel::UnlinkFromOwner(int32 Index)
+{
+	FTimer& Timer = this->Timers[Index];
+
+	if (Timer.Owner == NULL)
+	{
+		return;
+	}
+
+	if (Timer.OwnerPrev != INDEX_NONE)
+	{
+		this->Timers[Timer.OwnerPrev].OwnerNext = Timer.OwnerNext;
+	}
+	else if (Timer.OwnerNext != INDEX_NONE)
+	{
+		this->OwnerHeads.Add(Timer.Owner, Timer.OwnerNext);
+	}
+	else
+	{
+		this->OwnerHeads.Remove(Timer.Owner);
+	}
+
+	if (Timer.OwnerNext != INDEX_NONE)
+	{
+		this->Timers[Timer.OwnerNext].OwnerPrev = Timer.OwnerPrev;
+	}
+
+	Timer.Owner = NULL;
+	Timer.OwnerPrev = INDEX_NONE;
+	Timer.OwnerNext = INDEX_NONE;
+}
+
+void FGameplayTimerWheel::Release(int32 Index)
+{
+	this->UnlinkFromList(Index);
+	this->UnlinkFromOwner(Index);
+
+	FTimer& Timer = this->Timers[Index];
+	Timer.Delegate.Unbind();
+	Timer.Serial++;
+
+	// Free entries are only linked by Next
+	Timer.Next = this->FirstFree;
+	this->FirstFree = Index;
+
+	this->NumTimers--;
+}
+
+int32 FGameplayTimerWheel::Find(const FGameplayTimerHandle& Handle) const
+{
+	if (!this->Timers.IsValidIndex(Handle.Index))
+	{
+		return INDEX_NONE;
+	}
+
+	const FTimer& Timer = this->Timers[Handle.Index];
+
+	return ((Timer.Serial == Handle.Serial) && (Timer.List != INDEX_NONE)) ? Handle.Index : INDEX_NONE;
+}
+
+AGameplayTimerService::AGameplayTimerService(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	this->PrimaryActorTick.bCanEverTick = true;
+
+	// Fire the timers once the actors of the frame have ticked, like the timer manager
+	this->PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+}
+
+AGameplayTimerService* AGameplayTimerService::Get(UWorld* World)
+{
+	return GetWorldSingleton<AGameplayTimerService>(World);
+}
+
+void AGameplayTimerService::ClearTimer(FGameplayTimerHandle& Handle)
+{
+	this->Wheel.Cancel(Handle);
+}
+
+void AGameplayTimerService::ClearAllTimers(const UObject* Owner)
+{
+	this->Wheel.CancelAll(Owner);
+}
+
+bool AGameplayTimerService::IsTimerActive(const FGameplayTimerHandle& Handle) const
+{
+	return this->Wheel.IsActive(Handle);
+}
+
+void AGameplayTimerService::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_GameplayTimersAdvance);
+
+	const int32 NumFired = this->Wheel.Advance(DeltaTime);
+
+	INC_DWORD_STAT_BY(STAT_GameplayTimersFired, NumFired);
+	SET_DWORD_STAT(STAT_GameplayTimers, this->Wheel.GetNumTimers());
+}
+
+#if !UE_BUILD_SHIPPING
+
+static int32 NumBenchmarkTimersFired = 0;
+
+static void OnBenchmarkTimer()
+{
+	NumBenchmarkTimersFired++;
+}
+
+/** Compares the timing wheel with the engine's timer manager: schedules the timers and fires all of them */
+static void ExecTimerBenchmark(const TArray<FString>& Args)
+{
+	const int32 Count = (Args.Num() > 0) ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 10000;
+	const float MaxDelay = 10.f;
+
+	FRandomStream Random(Count);
+
+	TArray<float> Delays;
+	Delays.SetNum(Count);
+	for (int32 i = 0; i < Count; i++)
+	{
+		Delays[i] = Random.FRandRange(0.f, MaxDelay);
+	}
+
+	const FGameplayTimerDelegate WheelDelegate = FGameplayTimerDelegate::CreateStatic(&OnBenchmarkTimer);
+	const FTimerDelegate TimerManagerDelegate = FTimerDelegate::CreateStatic(&OnBenchmarkTimer);
+
+	// Timing wheel
+	NumBenchmarkTimersFired = 0;
+
+	FGameplayTimerWheel Wheel;
+	TArray<FGameplayTimerHandle> Handles;
+	Handles.SetNum(Count);
+
+	double StartTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < Count; i++)
+	{
+		Handles[i] = Wheel.Schedule(NULL, Delays[i], WheelDelegate);
+	}
+	const double WheelScheduleTime = FPlatformTime::Seconds() - StartTime;
+
+	StartTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < Count; i += 2)
+	{
+		Wheel.Cancel(Handles[i]);
+	}
+	const double WheelCancelTime = FPlatformTime::Seconds() - StartTime;
+
+	StartTime = FPlatformTime::Seconds();
+	Wheel.Advance(MaxDelay + 1.f);
+	const double WheelFireTime = FPlatformTime::Seconds() - StartTime;
+
+	const int32 WheelFired = NumBenchmarkTimersFired;
+
+	// Timer manager (its timers can only be cleared by a search for their delegate, so the cancel is not compared)
+	NumBenchmarkTimersFired = 0;
+
+	FTimerManager TimerManager;
+
+	StartTime = FPlatformTime::Seconds();
+	for (int32 i = 0; i < Count; i++)
+	{
+		TimerManager.SetTimer(TimerManagerDelegate, Delays[i], false);
+	}
+	const double TimerManagerScheduleTime = FPlatformTime::Seconds() - StartTime;
+
+	StartTime = FPlatformTime::Seconds();
+	TimerManager.Tick(MaxDelay + 1.f);
+	const double TimerManagerFireTime = FPlatformTime::Seconds() - StartTime;
+
+	const int32 TimerManagerFired = NumBenchmarkTimersFired;
+
+	UE_LOG(LogPacboy, Display, TEXT("Timer benchmark, %d timers:"), Count);
+	UE_LOG(LogPacboy, Display, TEXT("  Timing wheel: schedule %.3f ms, cancel half %.3f ms, fire %d in %.3f ms"),
+		WheelScheduleTime * 1000.0, WheelCancelTime * 1000.0, WheelFired, WheelFireTime * 1000.0);
+	UE_LOG(LogPacboy, Display, TEXT("  Timer manager: schedule %.3f ms, fire %d in %.3f ms"),
+		TimerManagerScheduleTime * 1000.0, TimerManagerFired, TimerManagerFireTime * 1000.0);
+}
+
+static FAutoConsoleCommand TimerBenchmarkCommand(
+	TEXT("Pacboy.TimerBenchmark"),
+	TEXT("Compares the gameplay timing wheel with the engine's timer manager. Arguments: [NumTimers] (10000 by default)"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&ExecTimerBenchmark));
+
+#endif
@@ -0,0 +1,53 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Pacboy.h"
+#include "HitDescriptor.h"
+
+FHitDescriptor::FHitDescriptor(const FHitResult& Hit, EHitZone::Type InHitZone, uint16 InShotSequence)
+	: Target(Hit.GetActor())
+	, ImpactPoint(Hit.ImpactPoint)
+	, HitZone(InHitZone)
+	, ShotSequence(InShotSequence)
+{
+}
+
+FHitResult FHitDescriptor::ToHitResult(const FVector& TraceStart) const
+{
+	// Far enough past the impact point for the trace to cross the hitboxes of the target
+	const float TraceOvershoot = 100.f;
+
+	const FVector TraceDirection = (this->ImpactPoint - TraceStart).SafeNormal();
+
+	FHitResult Hit;
+	Hit.bBlockingHit = true;
+	Hit.Actor = this->Target;
+	Hit.Location = this->ImpactPoint;
+	Hit.ImpactPoint = this->ImpactPoint;
+	Hit.Normal = -TraceDirection;
+	Hit.ImpactNormal = -TraceDirection;
+	Hit.TraceStart = TraceStart;
+	Hit.TraceEnd = this->ImpactPoint + (TraceDirection * TraceOvershoot);
+
+	return Hit;
+}
+
+bool FHitDescriptor::NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess)
+{
+	UObject* TargetObject = this->Target;
+	bOutSuccess = Map->SerializeObject(Ar, AActor::StaticClass(), TargetObject);
+
+	if (Ar.IsLoading())
+	{
+		this->Target = Cast<AActor>(TargetObject);
+	}
+
+	bool bSuccess = true;
+	this->ImpactPoint.NetSerialize(Ar, Map, bSuccess);
+	bOutSuccess &= bSuccess;
+
+	uint32 Zone = FMath::Min<uint32>(this->HitZone, EHitZone::NumZones - 1);
+	Ar.SerializeInt(Zone, EHitZone::NumZones);
+	this->HitZone = (uint8)Zone;
+
+	return true;
+}
@@ -0,0 +1,208 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Pacboy.h"
+#include "LagCompensationComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("Lag Compensation Rewind"), STAT_LagCompensationRewind, STATGROUP_Pacboy);
+DECLARE_MEMORY_STAT(TEXT("Lag Compensation History"), STAT_LagCompensationMemory, STATGROUP_Pacboy);
+
+ULagCompensationComponent::ULagCompensationComponent(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	this->PrimaryComponentTick.bCanEverTick = true;
+
+	// Record the pose after the character has moved
+	this->PrimaryComponentTick.TickGroup = TG_PostPhysics;
+
+	this->HistoryDuration = 1.f;
+	this->SnapshotRate = 60.f;
+	this->HeadBoneName = FName(TEXT("head"));
+	this->HeadRadius = 15.f;
+	this->HitTolerance = 15.f;
+
+	this->OldestIndex = 0;
+	this->NumSnapshots = 0;
+	this->TimeUntilNextSnapshot = 0.f;
+}
+
+void ULagCompensationComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	// The history is only needed by the server
+	if (this->GetOwner()->Role < ROLE_Authority)
+	{
+		this->SetComponentTickEnabled(false);
+		return;
+	}
+
+	this->TimeUntilNextSnapshot -= DeltaTime;
+
+	if (this->TimeUntilNextSnapshot <= 0.f)
+	{
+		this->TimeUntilNextSnapshot += 1.f / this->SnapshotRate;
+		this->RecordSnapshot();
+	}
+}
+
+void ULagCompensationComponent::OnComponentDestroyed()
+{
+	DEC_MEMORY_STAT_BY(STAT_LagCompensationMemory, this->Snapshots.GetAllocatedSize());
+
+	this->Snapshots.Empty();
+	this->NumSnapshots = 0;
+
+	Super::OnComponentDestroyed();
+}
+
+void ULagCompensationComponent::AllocateHistory()
+{
+	const int32 Capacity = FMath::Max(FMath::CeilToInt(this->HistoryDuration * this->SnapshotRate), 2);
+
+	this->Snapshots.SetNum(Capacity);
+	this->OldestIndex = 0;
+	this->NumSnapshots = 0;
+
+	INC_MEMORY_STAT_BY(STAT_LagCompensationMemory, this->Snapshots.GetAllocatedSize());
+}
+
+void ULagCompensationComponent::ClearHistory()
+{
+	this->OldestIndex = 0;
+	this->NumSnapshots = 0;
+	this->TimeUntilNextSnapshot = 0.f;
+}
+
+void ULagCompensationComponent::RecordSnapshot()
+{
+	const ACharacter* Character = Cast<ACharacter>(this->GetOwner());
+	if (Character == NULL)
+	{
+		return;
+	}
+
+	if (this->Snapshots.Num() == 0)
+	{
+		this->AllocateHistory();
+	}
+
+	const int32 Capacity = this->Snapshots.Num();
+
+	// Overwrite the oldest pose once the buffer is full
+	int32 Index;
+	if (this->NumSnapshots < Capacity)
+	{
+		Index = (this->OldestIndex + this->NumSnapshots) % Capacity;
+		this->NumSnapshots++;
+	}
+	else
+	{
+		Index = this->OldestIndex;
+		this->OldestIndex = (this->OldestIndex + 1) % Capacity;
+	}
+
+	FCharacterPoseSnapshot& Snapshot = this->Snapshots[Index];
+	Snapshot.Time = this->GetWorld()->GetTimeSeconds();
+	Snapshot.CapsuleLocation = Character->GetCapsuleComponent()->GetComponentLocation();
+	Snapshot.CapsuleRotation = Character->GetCapsuleComponent()->GetComponentQuat();
+
+	const USkeletalMeshComponent* Mesh = Character->GetMesh();
+	if ((Mesh != NULL) && (Mesh->GetBoneIndex(this->HeadBoneName) != INDEX_NONE))
+	{
+		Snapshot.HeadLocation = Mesh->GetSocketLocation(this->HeadBoneName);
+	}
+	else
+	{
+		Snapshot.HeadLocation = Snapshot.CapsuleLocation + (Snapshot.CapsuleRotation.RotateVector(FVector::UpVector) * Character->GetCapsuleComponent()->GetScaledCapsuleHalfHeight());
+	}
+}
+
+const FCharacterPoseSnapshot& ULagCompensationComponent::GetSnapshot(int32 Index) const
+{
+	return this->Snapshots[(this->OldestIndex + Index) % this->Snapshots.Num()];
+}
+
+bool ULagCompensationComponent::GetPoseAtTime(float Time, FCharacterPoseSnapshot& OutPose) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_LagCompensationRewind);
+
+	if (this->NumSnapshots == 0)
+	{
+		return false;
+	}
+
+	if (Time <= this->GetSnapshot(0).Time)
+	{
+		OutPose = this->GetSnapshot(0);
+		return true;
+	}
+
+	if (Time >= this->GetSnapshot(this->NumSnapshots - 1).Time)
+	{
+		OutPose = this->GetSnapshot(this->NumSnapshots - 1);
+		return true;
+	}
+
+	// Binary search for the first pose recorded after the given time
+	int32 Low = 1;
+	int32 High = this->NumSnapshots - 1;
+
+	while (Low < High)
+	{
+		const int32 Middle = (Low + High) / 2;
+
+		if (this->GetSnapshot(Middle).Time < Time)
+		{
+			Low = Middle + 1;
+		}
+		else
+		{
+			High = Middle;
+		}
+	}
+
+	const FCharacterPoseSnapshot& Before = this->GetSnapshot(Low - 1);
+	const FCharacterPoseSnapshot& After = this->GetSnapshot(Low);
+
+	const float Alpha = (Time - Before.Time) / FMath::Max(After.Time - Before.Time, KINDA_SMALL_NUMBER);
+
+	OutPose.Time = Time;
+	OutPose.CapsuleLocation = FMath::Lerp(Before.CapsuleLocation, After.CapsuleLocation, Alpha);
+	OutPose.CapsuleRotation = FQuat::Slerp(Before.CapsuleRotation, After.CapsuleRotation, Alpha);
+	OutPose.HeadLocation = FMath::Lerp(Before.HeadLocation, After.HeadLocation, Alpha);
+
+	return true;
+}
+
+bool ULagCompensationComponent::DoesShotHitAtTime(float Time, const FVector& TraceStart, const FVector& TraceEnd) const
+{
+	const ACharacter* Character = Cast<ACharacter>(this->GetOwner());
+	if (Character == NULL)
+	{
+		return false;
+	}
+
+	FCharacterPoseSnapshot Pose;
+	if (!this->GetPoseAtTime(Time, Pose))
+	{
+		return false;
+	}
+
+	// Head hitbox
+	if (FMath::PointDistToSegment(Pose.HeadLocation, TraceStart, TraceEnd) <= (this->HeadRadius + this->HitTolerance))
+	{
+		return true;
+	}
+
+	// Capsule hitbox (the distance between the shot and the capsule's inner segment)
+	const UCapsuleComponent* Capsule = Character->GetCapsuleComponent();
+	const float Radius = Capsule->GetScaledCapsuleRadius();
+	const float SegmentHalfLength = FMath::Max(Capsule->GetScaledCapsuleHalfHeight() - Radius, 0.f);
+	const FVector CapsuleAxis = Pose.CapsuleRotation.RotateVector(FVector::UpVector) * SegmentHalfLength;
+
+	FVector ClosestOnShot;
+	FVector ClosestOnCapsule;
+	FMath::SegmentDistToSegment(TraceStart, TraceEnd, Pose.CapsuleLocation - CapsuleAxis, Pose.CapsuleLocation + CapsuleAxis, ClosestOnShot, ClosestOnCapsule);
+
+	return FVector::Dist(ClosestOnShot, ClosestOnCapsule) <= (Radius + this->HitTolerance);
+}
@@ -0,0 +1,160 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Pacboy.h"
+#include "LoadReport.h"
+#include "NetStats.h"
+#include "WorldSingleton.h"
+
+int64 APacboyLoadReport::TotalActorSpawns = 0;
+int64 APacboyLoadReport::TotalActorDestroys = 0;
+
+void FLoadSample::Add(const FLoadSample& Other)
+{
+	this->Frames += Other.Frames;
+	this->GameThreadTime += Other.GameThreadTime;
+	this->MaxGameThreadTime = FMath::Max(this->MaxGameThreadTime, Other.MaxGameThreadTime);
+	this->OutBytes += Other.OutBytes;
+	this->InBytes += Other.InBytes;
+	this->RPCs += Other.RPCs;
+	this->ActorSpawns += Other.ActorSpawns;
+	this->ActorDestroys += Other.ActorDestroys;
+	this->MaxUsedMemory = FMath::Max(this->MaxUsedMemory, Other.MaxUsedMemory);
+	this->Duration += Other.Duration;
+}
+
+/** Returns how much a net driver counter grew since the last value (the counters are reset periodically) */
+static int64 GetCounterDelta(int32 Value, int32 LastValue)
+{
+	return (Value >= LastValue) ? (Value - LastValue) : Value;
+}
+
+APacboyLoadReport::APacboyLoadReport(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	this->PrimaryActorTick.bCanEverTick = true;
+	this->PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+
+	this->ReportInterval = 5.f;
+	this->LastOutBytes = 0;
+	this->LastInBytes = 0;
+	this->LastRPCs = 0;
+	this->LastActorSpawns = 0;
+	this->LastActorDestroys = 0;
+}
+
+bool APacboyLoadReport::IsEnabled(float& OutInterval)
+{
+	return FParse::Value(FCommandLine::Get(), TEXT("PacboyLoadReport="), OutInterval) && (OutInterval > 0.f);
+}
+
+APacboyLoadReport* APacboyLoadReport::Get(UWorld* World)
+{
+	if ((World == NULL) || ((World->GetNetMode() != NM_DedicatedServer) && (World->GetNetMode() != NM_ListenServer)))
+	{
+		return NULL;
+	}
+
+	return GetWorldSingleton<APacboyLoadReport>(World);
+}
+
+void APacboyLoadReport::RecordActorSpawned()
+{
+	TotalActorSpawns++;
+}
+
+void APacboyLoadReport::RecordActorDestroyed()
+{
+	TotalActorDestroys++;
+}
+
+void APacboyLoadReport::BeginPlay()
+{
+	Super::BeginPlay();
+
+	IsEnabled(this->ReportInterval);
+	this->ReportInterval = FMath::Max(this->ReportInterval, 1.f);
+
+	this->LastActorSpawns = TotalActorSpawns;
+	this->LastActorDestroys = TotalActorDestroys;
+
+#if PACBOY_NET_STATS
+	FNetStats::SetEnabled(true);
+	this->LastRPCs = FNetStats::GetTotalRPCs();
+#endif
+}
+
+void APacboyLoadReport::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// The game thread time excludes the time the server waits for its next frame
+	const float GameThreadTime = FPlatformTime::ToMilliseconds(GGameThreadTime);
+
+	this->Current.Frames++;
+	this->Current.GameThreadTime += GameThreadTime;
+	this->Current.MaxGameThreadTime = FMath::Max(this->Current.MaxGameThreadTime, GameThreadTime);
+	this->Current.Duration += FApp::GetDeltaTime();
+
+	const UNetDriver* NetDriver = this->GetWorld()->GetNetDriver();
+	if (NetDriver != NULL)
+	{
+		this->Current.OutBytes += GetCounterDelta(NetDriver->OutBytes, this->LastOutBytes);
+		this->Current.InBytes += GetCounterDelta(NetDriver->InBytes, this->LastInBytes);
+
+		this->LastOutBytes = NetDriver->OutBytes;
+		this->LastInBytes = NetDriver->InBytes;
+	}
+
+#if PACBOY_NET_STATS
+	this->Current.RPCs += FNetStats::GetTotalRPCs() - this->LastRPCs;
+	this->LastRPCs = FNetStats::GetTotalRPCs();
+#endif
+
+	this->Current.ActorSpawns += TotalActorSpawns - this->LastActorSpawns;
+	this->Current.ActorDestroys += TotalActorDestroys - this->LastActorDestroys;
+	this->LastActorSpawns = TotalActorSpawns;
+	this->LastActorDestroys = TotalActorDestroys;
+
+	if (this->Current.Duration >= this->ReportInterval)
+	{
+		this->Current.MaxUsedMemory = FMath::Max<uint64>(this->Current.MaxUsedMemory, FPlatformMemory::GetStats().UsedPhysical);
+
+		this->Report(TEXT("Load"), this->Current);
+
+		this->Total.Add(this->Current);
+		this->Current = FLoadSample();
+	}
+}
+
+void APacboyLoadReport::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	this->Current.MaxUsedMemory = FMath::Max<uint64>(this->Current.MaxUsedMemory, FPlatformMemory::GetStats().UsedPhysical);
+
+	this->Total.Add(this->Current);
+	this->Report(TEXT("Load (whole run)"), this->Total);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void APacboyLoadReport::Report(const TCHAR* Label, const FLoadSample& Sample) const
+{
+	if ((Sample.Frames == 0) || (Sample.Duration <= 0.f))
+	{
+		return;
+	}
+
+	const int32 NumPlayers = this->GetWorld()->GetNumPlayerControllers();
+
+	UE_LOG(LogPacboy, Display, TEXT("%s: %d players, %.1f fps, game thread %.2f ms avg %.2f ms max, out %.1f KB/s, in %.1f KB/s, %.1f RPCs/s, %.1f spawns/min, %.1f destroys/min, %.1f MB used"),
+		Label,
+		NumPlayers,
+		Sample.Frames / Sample.Duration,
+		Sample.GameThreadTime / Sample.Frames,
+		Sample.MaxGameThreadTime,
+		Sample.OutBytes / 1024.f / Sample.Duration,
+		Sample.InBytes / 1024.f / Sample.Duration,
+		Sample.RPCs / Sample.Duration,
+		Sample.ActorSpawns * 60.f / Sample.Duration,
+		Sample.ActorDestroys * 60.f / Sample.Duration,
+		Sample.MaxUsedMemory / (1024.f * 1024.f));
+}
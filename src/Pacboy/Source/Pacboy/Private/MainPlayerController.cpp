@@ -2,6 +2,8 @@
 
 #include "Pacboy.h"
 #include "MainPlayerController.h"
+#include "NetStats.h"
+#include "PacboyBotDriver.h"
 
 #include "UnrealNetwork.h"
 
@@ -17,3 +19,30 @@ void AMainPlayerController::GetLifetimeReplicatedProps(TArray< FLifetimeProperty
 	DOREPLIFETIME(AMainPlayerController, Kills);
 	DOREPLIFETIME(AMainPlayerController, Deaths);
 }
+
+void AMainPlayerController::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (APacboyBotDriver::IsEnabled())
+	{
+		APacboyBotDriver::Get(this->GetWorld());
+	}
+}
+
+bool AMainPlayerController::CallRemoteFunction(UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack)
+{
+#if PACBOY_NET_STATS
+	FNetStatsRPCScope NetStatsScope(this, Function);
+#endif
+
+	return Super::CallRemoteFunction(Function, Parameters, OutParms, Stack);
+}
+
+void AMainPlayerController::PlayCosmeticEvents_Client_Implementation(const TArray<FCosmeticEvent>& Events)
+{
+	for (const FCosmeticEvent& Event : Events)
+	{
+		ACosmeticEventRelay::PlayEvent(Event);
+	}
+}
\ No newline at end of file
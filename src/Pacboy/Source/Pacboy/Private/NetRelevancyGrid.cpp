@@ -0,0 +1,380 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Pacboy.h"
+#include "NetRelevancyGrid.h"
+#include "WorldSingleton.h"
+#include "EngineUtils.h"
+
+DECLARE_CYCLE_STAT(TEXT("Relevancy Grid Gather"), STAT_RelevancyGridGather, STATGROUP_Pacboy);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Relevancy Grid Actors"), STAT_RelevancyGridActors, STATGROUP_Pacboy);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Relevancy Grid Viewers"), STAT_RelevancyGridViewers, STATGROUP_Pacboy);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Relevancy Grid Cell Changes"), STAT_RelevancyGridCellChanges, STATGROUP_Pacboy);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Relevancy Grid Relevant Pairs"), STAT_RelevancyGridRelevantPairs, STATGROUP_Pacboy);
+
+ANetRelevancyGrid::ANetRelevancyGrid(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	this->PrimaryActorTick.bCanEverTick = true;
+
+	// Gather the relevant actors once everything has moved, right before the net driver replicates them
+	this->PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+
+	this->CellSize = 2500.f;
+	this->RelevantDistance = 15000.f; // The default net cull distance of actors
+	this->NearPriorityScale = 2.f;
+	this->FarPriorityScale = 0.25f;
+}
+
+ANetRelevancyGrid* ANetRelevancyGrid::Get(UWorld* World)
+{
+	// Only servers replicate actors
+	if ((World == NULL) || ((World->GetNetMode() != NM_DedicatedServer) && (World->GetNetMode() != NM_ListenServer)))
+	{
+		return NULL;
+	}
+
+	return GetWorldSingleton<ANetRelevancyGrid>(World);
+}
+
+FIntPoint ANetRelevancyGrid::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / this->CellSize), FMath::FloorToInt(Location.Y / this->CellSize));
+}
+
+void ANetRelevancyGrid::UpdateActor(AActor* Actor)
+{
+	const FIntPoint Cell = this->GetCell(Actor->GetActorLocation());
+
+	FIntPoint* CurrentCell = this->ActorCells.Find(Actor);
+	if (CurrentCell != NULL)
+	{
+		if (*CurrentCell == Cell)
+		{
+			return;
+		}
+
+		TArray<AActor*>* CurrentCellActors = this->Cells.Find(*CurrentCell);
+		if (CurrentCellActors != NULL)
+		{
+			CurrentCellActors->RemoveSingleSwap(Actor);
+
+			if (CurrentCellActors->Num() == 0)
+			{
+				this->Cells.Remove(*CurrentCell);
+			}
+		}
+
+		*CurrentCell = Cell;
+
+		INC_DWORD_STAT(STAT_RelevancyGridCellChanges);
+	}
+	else
+	{
+		this->ActorCells.Add(Actor, Cell);
+
+		SET_DWORD_STAT(STAT_RelevancyGridActors, this->ActorCells.Num());
+	}
+
+	this->Cells.FindOrAdd(Cell).Add(Actor);
+}
+
+void ANetRelevancyGrid::RemoveActor(AActor* Actor)
+{
+	const FIntPoint* CurrentCell = this->ActorCells.Find(Actor);
+	if (CurrentCell == NULL)
+	{
+		return;
+	}
+
+	TArray<AActor*>* CurrentCellActors = this->Cells.Find(*CurrentCell);
+	if (CurrentCellActors != NULL)
+	{
+		CurrentCellActors->RemoveSingleSwap(Actor);
+
+		if (CurrentCellActors->Num() == 0)
+		{
+			this->Cells.Remove(*CurrentCell);
+		}
+	}
+
+	this->ActorCells.Remove(Actor);
+
+	// The actor may be destroyed before the next gather
+	for (auto It = this->RelevantActors.CreateIterator(); It; ++It)
+	{
+		It.Value().Remove(Actor);
+	}
+
+	SET_DWORD_STAT(STAT_RelevancyGridActors, this->ActorCells.Num());
+}
+
+void ANetRelevancyGrid::GatherActorsInRadius(const FVector& Location, float Radius, TArray<AActor*>& OutActors) const
+{
+	const FIntPoint MinCell = this->GetCell(Location - FVector(Radius));
+	const FIntPoint MaxCell = this->GetCell(Location + FVector(Radius));
+	const float RadiusSquared = FMath::Square(Radius);
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+		{
+			const TArray<AActor*>* CellActors = this->Cells.Find(FIntPoint(X, Y));
+			if (CellActors == NULL)
+			{
+				continue;
+			}
+
+			for (AActor* Actor : *CellActors)
+			{
+				if (FVector::DistSquared(Location, Actor->GetActorLocation()) <= RadiusSquared)
+				{
+					OutActors.Add(Actor);
+				}
+			}
+		}
+	}
+}
+
+bool ANetRelevancyGrid::IsTrackingViewer(const APlayerController* Viewer) const
+{
+	return this->RelevantActors.Contains(Viewer);
+}
+
+bool ANetRelevancyGrid::IsRelevantFor(const AActor* Actor, const APlayerController* Viewer) const
+{
+	const TMap<const AActor*, float>* ViewerActors = this->RelevantActors.Find(Viewer);
+
+	return (ViewerActors != NULL) && ViewerActors->Contains(Actor);
+}
+
+float ANetRelevancyGrid::GetPriorityScale(const AActor* Actor, const APlayerController* Viewer) const
+{
+	const TMap<const AActor*, float>* ViewerActors = this->RelevantActors.Find(Viewer);
+	if (ViewerActors == NULL)
+	{
+		return 0.f;
+	}
+
+	const float* DistanceSquared = ViewerActors->Find(Actor);
+	if (DistanceSquared == NULL)
+	{
+		return 0.f;
+	}
+
+	const float Alpha = FMath::Clamp(FMath::Sqrt(*DistanceSquared) / this->RelevantDistance, 0.f, 1.f);
+
+	return FMath::Lerp(this->NearPriorityScale, this->FarPriorityScale, Alpha);
+}
+
+void ANetRelevancyGrid::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_RelevancyGridGather);
+
+	// The sets of the previous frame are reused to avoid reallocating them
+	for (auto It = this->RelevantActors.CreateIterator(); It; ++It)
+	{
+		It.Value().Reset();
+	}
+
+	int32 Viewers = 0;
+
+	for (FConstPlayerControllerIterator It = this->GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = *It;
+
+		// Nothing is replicated to the local players
+		if ((PlayerController == NULL) || PlayerController->IsLocalController())
+		{
+			continue;
+		}
+
+		TMap<const AActor*, float>& ViewerActors = this->RelevantActors.FindOrAdd(PlayerController);
+		this->GatherRelevantActors(PlayerController, ViewerActors);
+
+		INC_DWORD_STAT_BY(STAT_RelevancyGridRelevantPairs, ViewerActors.Num());
+
+		Viewers++;
+	}
+
+	// Drop the players that left since the last frame
+	if (this->RelevantActors.Num() != Viewers)
+	{
+		for (auto It = this->RelevantActors.CreateIterator(); It; ++It)
+		{
+			if (It.Value().Num() == 0)
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+
+	SET_DWORD_STAT(STAT_RelevancyGridViewers, Viewers);
+}
+
+void ANetRelevancyGrid::GatherRelevantActors(const APlayerController* Viewer, TMap<const AActor*, float>& OutActors) const
+{
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	Viewer->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+	this->GatherRelevantActors(ViewLocation, OutActors);
+}
+
+void ANetRelevancyGrid::GatherRelevantActors(const FVector& ViewLocation, TMap<const AActor*, float>& OutActors) const
+{
+	const FIntPoint ViewCell = this->GetCell(ViewLocation);
+	const int32 CellRadius = FMath::CeilToInt(this->RelevantDistance / this->CellSize);
+	const float RelevantDistanceSquared = FMath::Square(this->RelevantDistance);
+
+	for (int32 X = ViewCell.X - CellRadius; X <= ViewCell.X + CellRadius; X++)
+	{
+		for (int32 Y = ViewCell.Y - CellRadius; Y <= ViewCell.Y + CellRadius; Y++)
+		{
+			const TArray<AActor*>* CellActors = this->Cells.Find(FIntPoint(X, Y));
+			if (CellActors == NULL)
+			{
+				continue;
+			}
+
+			for (const AActor* Actor : *CellActors)
+			{
+				const float DistanceSquared = FVector::DistSquared(ViewLocation, Actor->GetActorLocation());
+
+				if (DistanceSquared <= RelevantDistanceSquared)
+				{
+					OutActors.Add(Actor, DistanceSquared);
+				}
+			}
+		}
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+
+/**
+* Compares the relevancy and priority checks of the relevancy grid with a check per actor and connection
+* (the distance test of AActor::IsNetRelevantFor), on the server world of this process. The connections
+* are simulated by view points placed at random around the replicated actors, so the replicated actors
+* should be the ones of a real match (e.g. 64 characters with 63 bot clients, see APacboyBotDriver)
+*/
+static void ExecRelevancyBenchmark(const TArray<FString>& Args)
+{
+	const int32 NumFrames = 60;
+
+	TArray<int32> ConnectionCounts;
+	for (const FString& Arg : Args)
+	{
+		ConnectionCounts.Add(FMath::Max(FCString::Atoi(*Arg), 1));
+	}
+
+	if (ConnectionCounts.Num() == 0)
+	{
+		ConnectionCounts.Add(16);
+		ConnectionCounts.Add(32);
+		ConnectionCounts.Add(64);
+	}
+
+	UWorld* World = NULL;
+	ANetRelevancyGrid* RelevancyGrid = NULL;
+
+	for (const FWorldContext& Context : GEngine->GetWorldContexts())
+	{
+		RelevancyGrid = ANetRelevancyGrid::Get(Context.World());
+		if (RelevancyGrid != NULL)
+		{
+			World = Context.World();
+			break;
+		}
+	}
+
+	if (World == NULL)
+	{
+		UE_LOG(LogPacboy, Warning, TEXT("Relevancy benchmark: no server world"));
+		return;
+	}
+
+	TArray<const AActor*> ReplicatedActors;
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		if (It->GetIsReplicated() && !It->bAlwaysRelevant)
+		{
+			ReplicatedActors.Add(*It);
+		}
+	}
+
+	if (ReplicatedActors.Num() == 0)
+	{
+		UE_LOG(LogPacboy, Warning, TEXT("Relevancy benchmark: no replicated actors"));
+		return;
+	}
+
+	UE_LOG(LogPacboy, Display, TEXT("Relevancy benchmark, %d replicated actors, average of %d frames:"), ReplicatedActors.Num(), NumFrames);
+
+	FRandomStream Random(ReplicatedActors.Num());
+
+	TMap<const AActor*, float> ViewerActors;
+
+	for (const int32 NumConnections : ConnectionCounts)
+	{
+		TArray<FVector> ViewLocations;
+		ViewLocations.SetNum(NumConnections);
+		for (int32 i = 0; i < NumConnections; i++)
+		{
+			const AActor* ViewTarget = ReplicatedActors[Random.RandHelper(ReplicatedActors.Num())];
+			ViewLocations[i] = ViewTarget->GetActorLocation() + (Random.GetUnitVector() * Random.FRandRange(0.f, 1000.f));
+		}
+
+		// Relevancy grid: one gather per connection, then a lookup per actor and connection
+		int32 GridRelevantPairs = 0;
+
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 Frame = 0; Frame < NumFrames; Frame++)
+		{
+			for (const FVector& ViewLocation : ViewLocations)
+			{
+				ViewerActors.Reset();
+				RelevancyGrid->GatherRelevantActors(ViewLocation, ViewerActors);
+
+				for (const AActor* Actor : ReplicatedActors)
+				{
+					if (ViewerActors.Contains(Actor))
+					{
+						GridRelevantPairs++;
+					}
+				}
+			}
+		}
+		const double GridTime = FPlatformTime::Seconds() - StartTime;
+
+		// Check per actor and connection
+		int32 BruteForceRelevantPairs = 0;
+
+		StartTime = FPlatformTime::Seconds();
+		for (int32 Frame = 0; Frame < NumFrames; Frame++)
+		{
+			for (const FVector& ViewLocation : ViewLocations)
+			{
+				for (const AActor* Actor : ReplicatedActors)
+				{
+					if (FVector::DistSquared(ViewLocation, Actor->GetActorLocation()) < Actor->NetCullDistanceSquared)
+					{
+						BruteForceRelevantPairs++;
+					}
+				}
+			}
+		}
+		const double BruteForceTime = FPlatformTime::Seconds() - StartTime;
+
+		UE_LOG(LogPacboy, Display, TEXT("  %d connections: relevancy grid %.3f ms (%d relevant pairs), per actor and connection %.3f ms (%d relevant pairs)"),
+			NumConnections, GridTime * 1000.0 / NumFrames, GridRelevantPairs / NumFrames, BruteForceTime * 1000.0 / NumFrames, BruteForceRelevantPairs / NumFrames);
+	}
+}
+
+static FAutoConsoleCommand RelevancyBenchmarkCommand(
+	TEXT("Pacboy.RelevancyBenchmark"),
+	TEXT("Compares the relevancy grid with a relevancy check per actor and connection, on the server world. Arguments: [NumConnections...] (16 32 64 by default)"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&ExecRelevancyBenchmark));
+
+#endif
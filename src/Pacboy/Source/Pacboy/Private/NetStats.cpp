@@ -0,0 +1,265 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Pacboy.h"
+#include "NetStats.h"
+
+#if PACBOY_NET_STATS
+
+bool FNetStats::bEnabled = false;
+int64 FNetStats::TotalRPCs = 0;
+TMap<FString, TMap<FName, FNetStatsEntry>> FNetStats::Connections;
+float FNetStats::CSVInterval = 0.f;
+float FNetStats::TimeSinceCSVDump = 0.f;
+FTickerDelegate FNetStats::CSVTicker;
+FArchive* FNetStats::CSVFile = NULL;
+
+/** Handles the "Pacboy.NetStats" console command */
+static void ExecNetStatsCommand(const TArray<FString>& Args)
+{
+	const FString Command = (Args.Num() > 0) ? Args[0] : FString();
+
+	if (Command == TEXT("on"))
+	{
+		FNetStats::SetEnabled(true);
+	}
+	else if (Command == TEXT("off"))
+	{
+		FNetStats::SetEnabled(false);
+	}
+	else if (Command == TEXT("dump"))
+	{
+		FNetStats::Dump();
+	}
+	else if (Command == TEXT("reset"))
+	{
+		FNetStats::Reset();
+	}
+	else if ((Command == TEXT("csv")) && (Args.Num() > 1))
+	{
+		FNetStats::SetCSVInterval(FCString::Atof(*Args[1]));
+	}
+	else
+	{
+		UE_LOG(LogPacboy, Display, TEXT("Usage: Pacboy.NetStats on|off|dump|reset|csv <Seconds>"));
+	}
+}
+
+static FAutoConsoleCommand NetStatsCommand(
+	TEXT("Pacboy.NetStats"),
+	TEXT("Counts the network traffic of every RPC and replicated property, per connection. Arguments: on|off|dump|reset|csv <Seconds>"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&ExecNetStatsCommand));
+
+void FNetStats::SetEnabled(bool bInEnabled)
+{
+	bEnabled = bInEnabled;
+
+	UE_LOG(LogPacboy, Display, TEXT("Net stats %s"), bEnabled ? TEXT("enabled") : TEXT("disabled"));
+}
+
+void FNetStats::InitFromCommandLine()
+{
+	// Kept running across map changes
+	if (CSVInterval > 0.f)
+	{
+		return;
+	}
+
+	float Interval = 0.f;
+	if (IsRunningDedicatedServer() && FParse::Value(FCommandLine::Get(), TEXT("NetStatsCSV="), Interval))
+	{
+		SetCSVInterval(Interval);
+	}
+}
+
+FNetStatsEntry& FNetStats::FindOrAddEntry(UNetConnection* Connection, FName Name)
+{
+	const FString ConnectionName = (Connection != NULL) ? Connection->LowLevelGetRemoteAddress() : FString(TEXT("Unknown"));
+
+	return Connections.FindOrAdd(ConnectionName).FindOrAdd(Name);
+}
+
+void FNetStats::RecordRPC(UNetConnection* Connection, const UFunction* Function, int64 Bits, int32 ReliableBuffer)
+{
+	FNetStatsEntry& Entry = FindOrAddEntry(Connection, Function->GetFName());
+	Entry.Count++;
+	Entry.Bits += Bits;
+	Entry.MaxReliableBuffer = FMath::Max(Entry.MaxReliableBuffer, ReliableBuffer);
+
+	TotalRPCs++;
+}
+
+void FNetStats::RecordProperty(UPackageMap* Map, const TCHAR* PropertyName, int64 Bits)
+{
+	// The package map of a connection is created by the connection
+	UNetConnection* Connection = (Map != NULL) ? Cast<UNetConnection>(Map->GetOuter()) : NULL;
+
+	FNetStatsEntry& Entry = FindOrAddEntry(Connection, FName(PropertyName));
+	Entry.Count++;
+	Entry.Bits += Bits;
+}
+
+void FNetStats::Dump()
+{
+	UE_LOG(LogPacboy, Display, TEXT("Net stats (%d connections):"), Connections.Num());
+
+	for (auto ConnectionIt = Connections.CreateConstIterator(); ConnectionIt; ++ConnectionIt)
+	{
+		UE_LOG(LogPacboy, Display, TEXT("  %s"), *ConnectionIt.Key());
+
+		for (auto EntryIt = ConnectionIt.Value().CreateConstIterator(); EntryIt; ++EntryIt)
+		{
+			const FNetStatsEntry& Entry = EntryIt.Value();
+
+			UE_LOG(LogPacboy, Display, TEXT("    %-32s Count: %6d  Bytes: %8lld  Max reliable buffer: %d"),
+				*EntryIt.Key().ToString(), Entry.Count, (Entry.Bits + 7) / 8, Entry.MaxReliableBuffer);
+		}
+	}
+}
+
+void FNetStats::Reset()
+{
+	Connections.Reset();
+}
+
+void FNetStats::SetCSVInterval(float Interval)
+{
+	if (CSVTicker.IsBound())
+	{
+		FTicker::GetCoreTicker().RemoveTicker(CSVTicker);
+		CSVTicker.Unbind();
+	}
+
+	if (CSVFile != NULL)
+	{
+		CSVFile->Close();
+		delete CSVFile;
+		CSVFile = NULL;
+	}
+
+	CSVInterval = FMath::Max(Interval, 0.f);
+	TimeSinceCSVDump = 0.f;
+
+	if (CSVInterval <= 0.f)
+	{
+		return;
+	}
+
+	const FString FileName = FPaths::ProfilingDir() / TEXT("NetStats.csv");
+	const bool bNewFile = !IFileManager::Get().FileExists(*FileName);
+
+	CSVFile = IFileManager::Get().CreateFileWriter(*FileName, FILEWRITE_Append);
+	if (CSVFile == NULL)
+	{
+		UE_LOG(LogPacboy, Warning, TEXT("Can't open %s"), *FileName);
+		return;
+	}
+
+	if (bNewFile)
+	{
+		const ANSICHAR* Header = "Time,Connection,Name,Count,Bits,MaxReliableBuffer\n";
+		CSVFile->Serialize((void*)Header, FCStringAnsi::Strlen(Header));
+	}
+
+	SetEnabled(true);
+
+	CSVTicker = FTickerDelegate::CreateStatic(&FNetStats::TickCSV);
+	FTicker::GetCoreTicker().AddTicker(CSVTicker);
+}
+
+bool FNetStats::TickCSV(float DeltaTime)
+{
+	TimeSinceCSVDump += DeltaTime;
+
+	if (TimeSinceCSVDump >= CSVInterval)
+	{
+		TimeSinceCSVDump = 0.f;
+
+		WriteCSV();
+		Reset();
+	}
+
+	return true;
+}
+
+void FNetStats::WriteCSV()
+{
+	if (CSVFile == NULL)
+	{
+		return;
+	}
+
+	const FString Time = FDateTime::Now().ToString();
+
+	for (auto ConnectionIt = Connections.CreateConstIterator(); ConnectionIt; ++ConnectionIt)
+	{
+		for (auto EntryIt = ConnectionIt.Value().CreateConstIterator(); EntryIt; ++EntryIt)
+		{
+			const FNetStatsEntry& Entry = EntryIt.Value();
+
+			const FString Line = FString::Printf(TEXT("%s,%s,%s,%d,%lld,%d\n"),
+				*Time, *ConnectionIt.Key(), *EntryIt.Key().ToString(), Entry.Count, Entry.Bits, Entry.MaxReliableBuffer);
+
+			FTCHARToUTF8 UTF8Line(*Line);
+			CSVFile->Serialize((void*)UTF8Line.Get(), UTF8Line.Length());
+		}
+	}
+
+	CSVFile->Flush();
+}
+
+FNetStatsRPCScope::FNetStatsRPCScope(AActor* InActor, UFunction* InFunction)
+	: Actor(InActor)
+	, Function(InFunction)
+{
+	if (!FNetStats::IsEnabled())
+	{
+		return;
+	}
+
+	UNetDriver* NetDriver = this->Actor->GetNetDriver();
+	if (NetDriver == NULL)
+	{
+		return;
+	}
+
+	if (NetDriver->ServerConnection != NULL)
+	{
+		this->Connections.Add(NetDriver->ServerConnection);
+	}
+	else
+	{
+		this->Connections.Append(NetDriver->ClientConnections);
+	}
+
+	for (const UNetConnection* Connection : this->Connections)
+	{
+		this->ConnectionBits.Add(GetWrittenBits(Connection));
+	}
+}
+
+FNetStatsRPCScope::~FNetStatsRPCScope()
+{
+	for (int32 i = 0; i < this->Connections.Num(); i++)
+	{
+		UNetConnection* Connection = this->Connections[i];
+
+		const int64 Bits = GetWrittenBits(Connection) - this->ConnectionBits[i];
+		if (Bits <= 0)
+		{
+			continue;
+		}
+
+		const UActorChannel* Channel = Connection->ActorChannels.FindRef(this->Actor);
+		const int32 ReliableBuffer = (Channel != NULL) ? Channel->NumOutRec : 0;
+
+		FNetStats::RecordRPC(Connection, this->Function, Bits, ReliableBuffer);
+	}
+}
+
+int64 FNetStatsRPCScope::GetWrittenBits(const UNetConnection* Connection)
+{
+	// The bits flushed in packets plus the bits waiting in the send buffer
+	return ((int64)Connection->OutBytes * 8) + Connection->SendBuffer.GetNumBits();
+}
+
+#endif
@@ -3,3 +3,5 @@
 #include "Pacboy.h"
 
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, Pacboy, "Pacboy" );
+
+DEFINE_LOG_CATEGORY(LogPacboy);
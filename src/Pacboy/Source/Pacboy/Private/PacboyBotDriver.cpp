@@ -0,0 +1,253 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Pacboy.h"
+#include "PacboyBotDriver.h"
+#include "CharacterBase.h"
+#include "WorldSingleton.h"
+
+/** The chances (per decision) of the actions of a randomized profile */
+struct FBotBehaviour
+{
+	float Move;
+	float Sprint;
+	float Aim;
+	float Fire;
+	float Jump;
+	float Dash;
+	float Swap;
+	float Reload;
+};
+
+/** Indexed by EBotProfile (the scripted profile doesn't use it) */
+static const FBotBehaviour BotBehaviours[] =
+{
+	//	Move	Sprint	Aim		Fire	Jump	Dash	Swap	Reload
+	{	0.9f,	0.5f,	0.1f,	0.5f,	0.3f,	0.2f,	0.02f,	0.02f },	// Wander
+	{	0.4f,	0.f,	0.9f,	0.7f,	0.05f,	0.05f,	0.1f,	0.1f },		// Gunner
+	{	0.7f,	0.3f,	0.5f,	0.6f,	0.2f,	0.15f,	0.05f,	0.05f },	// Mixed
+	{	0.f,	0.f,	0.f,	0.f,	0.f,	0.f,	0.f,	0.f }		// Circle
+};
+
+APacboyBotDriver::APacboyBotDriver(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	this->PrimaryActorTick.bCanEverTick = true;
+
+	// The input is given before the characters move, like the player input
+	this->PrimaryActorTick.TickGroup = TG_PrePhysics;
+
+	this->Profile = EBotProfile::Mixed;
+	this->TimeToDecision = 0.f;
+	this->ScriptTime = 0.f;
+	this->ForwardAxis = 0.f;
+	this->RightAxis = 0.f;
+	this->TurnRate = 0.f;
+	this->bSprinting = false;
+	this->bAiming = false;
+	this->bFiring = false;
+}
+
+bool APacboyBotDriver::IsEnabled()
+{
+	return FParse::Param(FCommandLine::Get(), TEXT("PacboyBot")) || FCString::Strifind(FCommandLine::Get(), TEXT("-PacboyBot=")) != NULL;
+}
+
+APacboyBotDriver* APacboyBotDriver::Get(UWorld* World)
+{
+	// Bots only play on clients (or standalone), never on the dedicated server
+	if ((World == NULL) || (World->GetNetMode() == NM_DedicatedServer))
+	{
+		return NULL;
+	}
+
+	return GetWorldSingleton<APacboyBotDriver>(World);
+}
+
+void APacboyBotDriver::BeginPlay()
+{
+	Super::BeginPlay();
+
+	FString ProfileName;
+	if (FParse::Value(FCommandLine::Get(), TEXT("PacboyBot="), ProfileName))
+	{
+		if (ProfileName == TEXT("Wander"))
+		{
+			this->Profile = EBotProfile::Wander;
+		}
+		else if (ProfileName == TEXT("Gunner"))
+		{
+			this->Profile = EBotProfile::Gunner;
+		}
+		else if (ProfileName == TEXT("Circle"))
+		{
+			this->Profile = EBotProfile::Circle;
+		}
+	}
+
+	int32 Seed = 0;
+	if (!FParse::Value(FCommandLine::Get(), TEXT("PacboyBotSeed="), Seed))
+	{
+		Seed = (int32)FPlatformTime::Cycles();
+	}
+
+	this->Random.Initialize(Seed);
+
+	UE_LOG(LogPacboy, Display, TEXT("Bot started (profile %s, seed %d)"), ProfileName.IsEmpty() ? TEXT("Mixed") : *ProfileName, Seed);
+}
+
+void APacboyBotDriver::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	APlayerController* PlayerController = this->GetWorld()->GetFirstPlayerController();
+	ACharacterBase* CurrentCharacter = (PlayerController != NULL) ? Cast<ACharacterBase>(PlayerController->GetPawn()) : NULL;
+
+	// A new character (after a respawn) starts with nothing pressed
+	if (CurrentCharacter != this->Character.Get())
+	{
+		this->Character = CurrentCharacter;
+		this->TimeToDecision = 0.f;
+		this->ScriptTime = 0.f;
+		this->bSprinting = false;
+		this->bAiming = false;
+		this->bFiring = false;
+	}
+
+	if ((CurrentCharacter == NULL) || CurrentCharacter->bIsDead)
+	{
+		return;
+	}
+
+	if (this->Profile == EBotProfile::Circle)
+	{
+		this->PlayScript(CurrentCharacter, DeltaTime);
+	}
+	else
+	{
+		this->TimeToDecision -= DeltaTime;
+
+		if (this->TimeToDecision <= 0.f)
+		{
+			this->TimeToDecision = this->Random.FRandRange(0.5f, 2.f);
+			this->Decide(CurrentCharacter);
+		}
+	}
+
+	CurrentCharacter->MoveForward(this->ForwardAxis);
+	CurrentCharacter->MoveRight(this->RightAxis);
+	PlayerController->AddYawInput(this->TurnRate * DeltaTime);
+}
+
+void APacboyBotDriver::Decide(ACharacterBase* InCharacter)
+{
+	const FBotBehaviour& Behaviour = BotBehaviours[this->Profile];
+
+	if (this->Random.FRand() < Behaviour.Move)
+	{
+		this->ForwardAxis = this->Random.FRandRange(-0.5f, 1.f);
+		this->RightAxis = this->Random.FRandRange(-1.f, 1.f);
+		this->TurnRate = this->Random.FRandRange(-90.f, 90.f);
+	}
+	else
+	{
+		this->ForwardAxis = 0.f;
+		this->RightAxis = 0.f;
+		this->TurnRate = 0.f;
+	}
+
+	const bool bAim = this->Random.FRand() < Behaviour.Aim;
+	this->ApplyHeldActions(InCharacter, this->Random.FRand() < Behaviour.Sprint, bAim, bAim && (this->Random.FRand() < Behaviour.Fire));
+
+	if (this->Random.FRand() < Behaviour.Jump)
+	{
+		InCharacter->Jump();
+	}
+
+	if (this->Random.FRand() < Behaviour.Dash)
+	{
+		if (this->Random.FRand() < 0.5f)
+		{
+			InCharacter->LeftDash();
+		}
+		else
+		{
+			InCharacter->RightDash();
+		}
+	}
+
+	if (this->Random.FRand() < Behaviour.Swap)
+	{
+		if (this->Random.FRand() < 0.5f)
+		{
+			InCharacter->SwapToRifle();
+		}
+		else
+		{
+			InCharacter->SwapToRocketLauncher();
+		}
+	}
+
+	if (this->Random.FRand() < Behaviour.Reload)
+	{
+		InCharacter->ReloadStart();
+	}
+}
+
+void APacboyBotDriver::PlayScript(ACharacterBase* InCharacter, float DeltaTime)
+{
+	const float JumpInterval = 3.f;
+
+	const float PreviousScriptTime = this->ScriptTime;
+	this->ScriptTime += DeltaTime;
+
+	this->ForwardAxis = 1.f;
+	this->RightAxis = 0.f;
+	this->TurnRate = 45.f;
+
+	this->ApplyHeldActions(InCharacter, false, true, true);
+
+	if (FMath::FloorToInt(this->ScriptTime / JumpInterval) != FMath::FloorToInt(PreviousScriptTime / JumpInterval))
+	{
+		InCharacter->Jump();
+	}
+}
+
+void APacboyBotDriver::ApplyHeldActions(ACharacterBase* InCharacter, bool bSprint, bool bAim, bool bFire)
+{
+	// Released in the opposite order they are pressed (firing needs aiming)
+	if (!bFire && this->bFiring)
+	{
+		InCharacter->FireStop();
+	}
+
+	if (!bAim && this->bAiming)
+	{
+		InCharacter->AimStop();
+	}
+
+	if (bSprint != this->bSprinting)
+	{
+		if (bSprint)
+		{
+			InCharacter->SprintStart();
+		}
+		else
+		{
+			InCharacter->SprintStop();
+		}
+	}
+
+	if (bAim && !this->bAiming)
+	{
+		InCharacter->AimStart();
+	}
+
+	if (bFire && !this->bFiring)
+	{
+		InCharacter->FireStart_Key();
+	}
+
+	this->bSprinting = bSprint;
+	this->bAiming = bAim;
+	this->bFiring = bFire;
+}
@@ -3,6 +3,35 @@
 #include "Pacboy.h"
 #include "PacboyGameMode.h"
 #include "MainPlayerController.h"
+#include "NetStats.h"
+#include "LoadReport.h"
+#include "CharacterBase.h"
+
+APacboyGameMode::APacboyGameMode(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	this->bRecycleCharacters = true;
+}
+
+void APacboyGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	Super::InitGame(MapName, Options, ErrorMessage);
+
+#if PACBOY_NET_STATS
+	FNetStats::InitFromCommandLine();
+#endif
+}
+
+void APacboyGameMode::StartPlay()
+{
+	Super::StartPlay();
+
+	float ReportInterval;
+	if (APacboyLoadReport::IsEnabled(ReportInterval))
+	{
+		APacboyLoadReport::Get(this->GetWorld());
+	}
+}
 
 void APacboyGameMode::ChangeName(AController* Other, const FString& S, bool bNameChange)
 {
@@ -12,4 +41,37 @@ void APacboyGameMode::ChangeName(AController* Other, const FString& S, bool bNam
 	}
 
 	Super::ChangeName(Other, S, true);
+}
+
+bool APacboyGameMode::RecycleCharacter(ACharacterBase* Character)
+{
+	if (!this->bRecycleCharacters || (Character == NULL))
+	{
+		return false;
+	}
+
+	AController* Controller = Character->GetController();
+	if (Controller == NULL)
+	{
+		return false;
+	}
+
+	// Same player start and rotation as for a new character (see AGameMode::RestartPlayer)
+	AActor* StartSpot = this->FindPlayerStart(Controller);
+	if (StartSpot == NULL)
+	{
+		return false;
+	}
+
+	const FRotator StartRotation(0.f, StartSpot->GetActorRotation().Yaw, 0.f);
+
+	if (!Character->Recycle(StartSpot->GetActorLocation(), StartRotation))
+	{
+		return false;
+	}
+
+	Controller->SetControlRotation(StartRotation);
+	Controller->ClientSetRotation(StartRotation);
+
+	return true;
 }
\ No newline at end of file
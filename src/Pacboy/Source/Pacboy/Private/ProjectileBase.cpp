@@ -2,7 +2,17 @@
 
 #include "Pacboy.h"
 #include "ProjectileBase.h"
+#include "ProjectilePool.h"
+#include "ProjectileSimulation.h"
+#include "NetRelevancyGrid.h"
 #include "DamageableObject.h"
+#include "EngineUtils.h"
+#include "UnrealNetwork.h"
+
+DECLARE_CYCLE_STAT(TEXT("Radial Damage"), STAT_RadialDamage, STATGROUP_Pacboy);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Radial Damage Candidates"), STAT_RadialDamageCandidates, STATGROUP_Pacboy);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Radial Damage Line Of Sight Checks"), STAT_RadialDamageLineOfSightChecks, STATGROUP_Pacboy);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Radial Damage Hits"), STAT_RadialDamageHits, STATGROUP_Pacboy);
 
 AProjectileBase::AProjectileBase(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
@@ -25,12 +35,25 @@ AProjectileBase::AProjectileBase(const FObjectInitializer& ObjectInitializer)
 	this->ProjectileMovement->bRotationFollowsVelocity = true;
 	this->ProjectileMovement->bShouldBounce = false;
 
-	// Destroy after 3 seconds by default
+	// Return to the projectile pool after 3 seconds in flight by default
 	this->InitialLifeSpan = 3.f;
 
 	this->Damage = 0.f;
+	this->RadialDamage = 0.f;
+	this->RadialDamageRadius = 0.f;
+	this->RadialDamageFalloff = NULL;
 	this->ImpulseForce = 100.f;
 
+	this->bInFlight = true;
+
+	// Moved by its own movement component unless the class opts in to the batched simulation
+	this->bUseBatchedSimulation = false;
+	this->SimulationIndex = INDEX_NONE;
+
+	// Only ticks while in flight on a server, to keep its cell in the relevancy grid up to date
+	this->PrimaryActorTick.bCanEverTick = true;
+	this->PrimaryActorTick.bStartWithTickEnabled = false;
+
 	this->ProjectileMesh = ObjectInitializer.CreateDefaultSubobject<UStaticMeshComponent>(this, FName(TEXT("ProjectileMesh")));
 	this->ProjectileMesh->AttachTo(this->RootComponent);
 
@@ -38,8 +61,200 @@ AProjectileBase::AProjectileBase(const FObjectInitializer& ObjectInitializer)
 	// are set in the derived blueprint classes (to avoid direct content references in C++)
 }
 
+void AProjectileBase::Launch(const FVector& Location, const FRotator& Rotation, AController* InShooter)
+{
+	this->Shooter = InShooter;
+	this->bInFlight = true;
+
+	this->SetActorLocationAndRotation(Location, Rotation);
+	this->SetActorHiddenInGame(false);
+
+	const FVector Velocity = Rotation.Vector() * this->ProjectileMovement->InitialSpeed;
+
+	AProjectileSimulation* Simulation = this->bUseBatchedSimulation ? AProjectileSimulation::Get(this->GetWorld()) : NULL;
+
+	if (Simulation != NULL)
+	{
+		// The simulation sweeps for hits itself, so the projectile's own collision stays disabled
+		Simulation->Add(this, Location, Velocity);
+	}
+	else
+	{
+		this->SetActorEnableCollision(true);
+
+		// The movement component drops its updated component when the projectile stops
+		this->ProjectileMovement->SetUpdatedComponent(this->CollisionComponent);
+		this->ProjectileMovement->Velocity = Velocity;
+		this->ProjectileMovement->Activate(true);
+	}
+
+	ANetRelevancyGrid* RelevancyGrid = ANetRelevancyGrid::Get(this->GetWorld());
+	if (RelevancyGrid != NULL)
+	{
+		RelevancyGrid->UpdateActor(this);
+
+		// The batched simulation updates the cell of its projectiles itself
+		this->SetActorTickEnabled(Simulation == NULL);
+	}
+
+	AGameplayTimerService* TimerService = AGameplayTimerService::Get(this->GetWorld());
+	if ((TimerService != NULL) && (this->InitialLifeSpan > 0.f))
+	{
+		TimerService->ClearTimer(this->LifeSpanTimer);
+		this->LifeSpanTimer = TimerService->SetTimer(this, &AProjectileBase::ReturnToPool, this->InitialLifeSpan);
+	}
+}
+
+void AProjectileBase::Deactivate()
+{
+	this->bInFlight = false;
+	this->Shooter = NULL;
+
+	if (this->LifeSpanTimer.IsValid())
+	{
+		AGameplayTimerService* TimerService = AGameplayTimerService::Get(this->GetWorld());
+		if (TimerService != NULL)
+		{
+			TimerService->ClearTimer(this->LifeSpanTimer);
+		}
+
+		this->LifeSpanTimer.Invalidate();
+	}
+
+	if (this->SimulationIndex != INDEX_NONE)
+	{
+		AProjectileSimulation* Simulation = AProjectileSimulation::Get(this->GetWorld());
+		if (Simulation != NULL)
+		{
+			Simulation->Remove(this);
+		}
+	}
+
+	this->ProjectileMovement->StopMovementImmediately();
+	this->ProjectileMovement->Deactivate();
+
+	this->SetActorHiddenInGame(true);
+	this->SetActorEnableCollision(false);
+	this->SetActorTickEnabled(false);
+
+	ANetRelevancyGrid* RelevancyGrid = ANetRelevancyGrid::Get(this->GetWorld());
+	if (RelevancyGrid != NULL)
+	{
+		RelevancyGrid->RemoveActor(this);
+	}
+}
+
+void AProjectileBase::ReturnToPool()
+{
+	AProjectilePool* ProjectilePool = AProjectilePool::Get(this->GetWorld());
+
+	if (ProjectilePool != NULL)
+	{
+		ProjectilePool->Release(this);
+	}
+	else
+	{
+		this->Destroy();
+	}
+}
+
+void AProjectileBase::GetLifetimeReplicatedProps(TArray< class FLifetimeProperty > & OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AProjectileBase, bInFlight);
+}
+
+void AProjectileBase::OnRep_InFlight()
+{
+	if (!this->bInFlight)
+	{
+		this->Deactivate();
+		return;
+	}
+
+	// The replicated movement already placed the proxy at its launch location
+	this->SetActorHiddenInGame(false);
+	this->SetActorEnableCollision(true);
+
+	this->ProjectileMovement->SetUpdatedComponent(this->CollisionComponent);
+	this->ProjectileMovement->Velocity = this->GetActorRotation().Vector() * this->ProjectileMovement->InitialSpeed;
+	this->ProjectileMovement->Activate(true);
+}
+
+void AProjectileBase::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Super::EndPlay(EndPlayReason);
+
+	AGameplayTimerService* TimerService = AGameplayTimerService::Get(this->GetWorld());
+	if (TimerService != NULL)
+	{
+		TimerService->ClearAllTimers(this);
+	}
+
+	ANetRelevancyGrid* RelevancyGrid = ANetRelevancyGrid::Get(this->GetWorld());
+	if (RelevancyGrid != NULL)
+	{
+		RelevancyGrid->RemoveActor(this);
+	}
+
+	if (this->SimulationIndex != INDEX_NONE)
+	{
+		AProjectileSimulation* Simulation = AProjectileSimulation::Get(this->GetWorld());
+		if (Simulation != NULL)
+		{
+			Simulation->Remove(this);
+		}
+	}
+}
+
+void AProjectileBase::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	ANetRelevancyGrid* RelevancyGrid = ANetRelevancyGrid::Get(this->GetWorld());
+	if (RelevancyGrid != NULL)
+	{
+		RelevancyGrid->UpdateActor(this);
+	}
+}
+
+bool AProjectileBase::IsNetRelevantFor(APlayerController* RealViewer, AActor* Viewer, const FVector& SrcLocation)
+{
+	ANetRelevancyGrid* RelevancyGrid = ANetRelevancyGrid::Get(this->GetWorld());
+
+	if ((RelevancyGrid == NULL) || !RelevancyGrid->IsTrackingViewer(RealViewer) || this->bAlwaysRelevant)
+	{
+		return Super::IsNetRelevantFor(RealViewer, Viewer, SrcLocation);
+	}
+
+	return RelevancyGrid->IsRelevantFor(this, RealViewer);
+}
+
+float AProjectileBase::GetNetPriority(const FVector& ViewPos, const FVector& ViewDir, APlayerController* Viewer, UActorChannel* InChannel, float Time, bool bLowBandwidth)
+{
+	ANetRelevancyGrid* RelevancyGrid = ANetRelevancyGrid::Get(this->GetWorld());
+
+	if ((RelevancyGrid == NULL) || !RelevancyGrid->IsRelevantFor(this, Viewer))
+	{
+		return Super::GetNetPriority(ViewPos, ViewDir, Viewer, InChannel, Time, bLowBandwidth);
+	}
+
+	return this->NetPriority * Time * RelevancyGrid->GetPriorityScale(this, Viewer);
+}
+
+void AProjectileBase::ProcessBatchedHit(const FHitResult& Hit)
+{
+	this->OnHit(Hit.GetActor(), Hit.GetComponent(), FVector::ZeroVector, Hit);
+}
+
 void AProjectileBase::OnHit(AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
 {
+	if (!this->bInFlight)
+	{
+		return;
+	}
+
 	if ((OtherActor != NULL) && (OtherActor != this))
 	{
 		AProjectileBase* OtherProj = Cast<AProjectileBase>(OtherActor);
@@ -70,6 +285,242 @@ void AProjectileBase::OnHit(AActor* OtherActor, UPrimitiveComponent* OtherComp,
 		}
 	}
 
+	if ((this->Role == ROLE_Authority) && (this->RadialDamageRadius > 0.f))
+	{
+		this->ApplyRadialDamage(Hit, OtherActor);
+	}
+
 	this->OnImpact(OtherActor, OtherComp);
-	this->Destroy();
+
+	// The proxies are pooled when the server pools the projectile (see OnRep_InFlight)
+	if (this->Role == ROLE_Authority)
+	{
+		this->ReturnToPool();
+	}
 }
+
+void AProjectileBase::ApplyRadialDamage(const FHitResult& Hit, const AActor* DirectHitActor)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RadialDamage);
+
+	UWorld* World = this->GetWorld();
+
+	TArray<AActor*> Candidates;
+	AProjectileBase::GatherRadialDamageCandidates(World, Hit.ImpactPoint, this->RadialDamageRadius, Candidates);
+
+	INC_DWORD_STAT_BY(STAT_RadialDamageCandidates, Candidates.Num());
+
+	// Off the impacted surface, so the surface doesn't block the line of sight
+	const FVector Origin = Hit.ImpactPoint + (Hit.ImpactNormal * 10.f);
+
+	for (AActor* Candidate : Candidates)
+	{
+		if ((Candidate == DirectHitActor) || (Candidate == this) || Candidate->IsPendingKill())
+		{
+			continue;
+		}
+
+		IDamageableObject* DamageableObject = Cast<IDamageableObject>(Candidate);
+		if (DamageableObject == NULL)
+		{
+			continue;
+		}
+
+		// Like the impact damage, the radial damage spares the shooter
+		const APawn* Pawn = Cast<APawn>(Candidate);
+		if ((Pawn != NULL) && (this->Shooter != NULL) && (Pawn->GetController() == this->Shooter))
+		{
+			continue;
+		}
+
+		const FVector TargetLocation = Candidate->GetActorLocation();
+
+		const float Distance = FVector::Dist(Hit.ImpactPoint, TargetLocation);
+		if (Distance > this->RadialDamageRadius)
+		{
+			continue;
+		}
+
+		INC_DWORD_STAT(STAT_RadialDamageLineOfSightChecks);
+
+		FCollisionQueryParams QueryParams(FName(TEXT("RadialDamageTrace")), false, this);
+		QueryParams.AddIgnoredActor(Candidate);
+
+		if (World->LineTraceTest(Origin, TargetLocation, ECollisionChannel::ECC_Visibility, QueryParams))
+		{
+			continue;
+		}
+
+		const float DistanceAlpha = Distance / this->RadialDamageRadius;
+		const float DamageScale = (this->RadialDamageFalloff != NULL) ? this->RadialDamageFalloff->GetFloatValue(DistanceAlpha) : (1.f - DistanceAlpha);
+
+		const float CandidateDamage = this->RadialDamage * FMath::Max(DamageScale, 0.f);
+		if (CandidateDamage <= 0.f)
+		{
+			continue;
+		}
+
+		const FVector Direction = (TargetLocation - Hit.ImpactPoint).SafeNormal();
+
+		FHitResult RadialHit;
+		RadialHit.bBlockingHit = true;
+		RadialHit.Actor = Candidate;
+		RadialHit.Location = TargetLocation;
+		RadialHit.ImpactPoint = TargetLocation;
+		RadialHit.Normal = -Direction;
+		RadialHit.ImpactNormal = -Direction;
+		RadialHit.TraceStart = Hit.ImpactPoint;
+		RadialHit.TraceEnd = TargetLocation;
+
+		DamageableObject->TakeDamage(CandidateDamage, RadialHit, this->Shooter);
+
+		INC_DWORD_STAT(STAT_RadialDamageHits);
+	}
+}
+
+void AProjectileBase::GatherRadialDamageCandidates(UWorld* World, const FVector& Location, float Radius, TArray<AActor*>& OutActors)
+{
+	ANetRelevancyGrid* RelevancyGrid = ANetRelevancyGrid::Get(World);
+	if (RelevancyGrid != NULL)
+	{
+		RelevancyGrid->GatherActorsInRadius(Location, Radius, OutActors);
+		return;
+	}
+
+	if (World == NULL)
+	{
+		return;
+	}
+
+	// Standalone games have no grid
+	TArray<FOverlapResult> Overlaps;
+	World->OverlapMulti(Overlaps, Location, FQuat::Identity, FCollisionShape::MakeSphere(Radius), FCollisionQueryParams(FName(TEXT("RadialDamageOverlap")), false),
+		FCollisionObjectQueryParams(FCollisionObjectQueryParams::InitType::AllDynamicObjects));
+
+	for (const FOverlapResult& Overlap : Overlaps)
+	{
+		AActor* Actor = Overlap.GetActor();
+		if ((Actor != NULL) && (Cast<IDamageableObject>(Actor) != NULL))
+		{
+			OutActors.AddUnique(Actor);
+		}
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+
+/**
+* Compares the broadphases of the radial damage on the server world of this process: the relevancy grid
+* and the engine's overlap query. The explosions are placed at random around the damageable actors
+* (e.g. 64 characters with 63 bot clients, see APacboyBotDriver). No damage is applied
+*/
+static void ExecRadialDamageBenchmark(const TArray<FString>& Args)
+{
+	const int32 NumExplosions = (Args.Num() > 0) ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 50;
+	const float Radius = (Args.Num() > 1) ? FMath::Max(FCString::Atof(*Args[1]), 1.f) : 500.f;
+
+	UWorld* World = NULL;
+	ANetRelevancyGrid* RelevancyGrid = NULL;
+
+	for (const FWorldContext& Context : GEngine->GetWorldContexts())
+	{
+		RelevancyGrid = ANetRelevancyGrid::Get(Context.World());
+		if (RelevancyGrid != NULL)
+		{
+			World = Context.World();
+			break;
+		}
+	}
+
+	if (World == NULL)
+	{
+		UE_LOG(LogPacboy, Warning, TEXT("Radial damage benchmark: no server world"));
+		return;
+	}
+
+	TArray<AActor*> DamageableActors;
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		if (Cast<IDamageableObject>(*It) != NULL)
+		{
+			DamageableActors.Add(*It);
+		}
+	}
+
+	if (DamageableActors.Num() == 0)
+	{
+		UE_LOG(LogPacboy, Warning, TEXT("Radial damage benchmark: no damageable actors"));
+		return;
+	}
+
+	FRandomStream Random(NumExplosions);
+
+	TArray<FVector> Explosions;
+	Explosions.SetNum(NumExplosions);
+	for (int32 i = 0; i < NumExplosions; i++)
+	{
+		const AActor* Target = DamageableActors[Random.RandHelper(DamageableActors.Num())];
+		Explosions[i] = Target->GetActorLocation() + (Random.GetUnitVector() * Random.FRandRange(0.f, Radius));
+	}
+
+	TArray<AActor*> Candidates;
+
+	// Relevancy grid
+	int32 GridCandidates = 0;
+
+	double StartTime = FPlatformTime::Seconds();
+	for (const FVector& Explosion : Explosions)
+	{
+		Candidates.Reset();
+		RelevancyGrid->GatherActorsInRadius(Explosion, Radius, Candidates);
+		GridCandidates += Candidates.Num();
+	}
+	const double GridTime = FPlatformTime::Seconds() - StartTime;
+
+	// Line of sight of the candidates of the grid
+	int32 LineOfSightChecks = 0;
+
+	StartTime = FPlatformTime::Seconds();
+	for (const FVector& Explosion : Explosions)
+	{
+		Candidates.Reset();
+		RelevancyGrid->GatherActorsInRadius(Explosion, Radius, Candidates);
+
+		for (const AActor* Candidate : Candidates)
+		{
+			if (Cast<IDamageableObject>(Candidate) != NULL)
+			{
+				FCollisionQueryParams QueryParams(FName(TEXT("RadialDamageTrace")), false, Candidate);
+				World->LineTraceTest(Explosion, Candidate->GetActorLocation(), ECollisionChannel::ECC_Visibility, QueryParams);
+				LineOfSightChecks++;
+			}
+		}
+	}
+	const double LineOfSightTime = FPlatformTime::Seconds() - StartTime;
+
+	// Overlap query
+	int32 OverlapCandidates = 0;
+	TArray<FOverlapResult> Overlaps;
+
+	StartTime = FPlatformTime::Seconds();
+	for (const FVector& Explosion : Explosions)
+	{
+		Overlaps.Reset();
+		World->OverlapMulti(Overlaps, Explosion, FQuat::Identity, FCollisionShape::MakeSphere(Radius), FCollisionQueryParams(FName(TEXT("RadialDamageOverlap")), false),
+			FCollisionObjectQueryParams(FCollisionObjectQueryParams::InitType::AllDynamicObjects));
+		OverlapCandidates += Overlaps.Num();
+	}
+	const double OverlapTime = FPlatformTime::Seconds() - StartTime;
+
+	UE_LOG(LogPacboy, Display, TEXT("Radial damage benchmark, %d explosions of radius %.0f among %d damageable actors:"), NumExplosions, Radius, DamageableActors.Num());
+	UE_LOG(LogPacboy, Display, TEXT("  Relevancy grid: %d candidates in %.3f ms (%d line of sight checks in %.3f ms, gather included)"),
+		GridCandidates, GridTime * 1000.0, LineOfSightChecks, LineOfSightTime * 1000.0);
+	UE_LOG(LogPacboy, Display, TEXT("  Overlap query: %d overlaps in %.3f ms"), OverlapCandidates, OverlapTime * 1000.0);
+}
+
+static FAutoConsoleCommand RadialDamageBenchmarkCommand(
+	TEXT("Pacboy.RadialDamageBenchmark"),
+	TEXT("Compares the relevancy grid with the overlap query as the broadphase of the radial damage, on the server world. Arguments: [NumExplosions] (50 by default) [Radius] (500 by default)"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&ExecRadialDamageBenchmark));
+
+#endif
@@ -0,0 +1,152 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Pacboy.h"
+#include "ProjectilePool.h"
+#include "WorldSingleton.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Projectile Pool Hits"), STAT_ProjectilePoolHits, STATGROUP_Pacboy);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Projectile Pool Misses"), STAT_ProjectilePoolMisses, STATGROUP_Pacboy);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Projectiles In Flight"), STAT_ProjectilesInFlight, STATGROUP_Pacboy);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Projectiles In Flight (High Water Mark)"), STAT_ProjectilesHighWaterMark, STATGROUP_Pacboy);
+
+AProjectilePool::AProjectilePool(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	this->PoolHits = 0;
+	this->PoolMisses = 0;
+	this->HighWaterMark = 0;
+	this->ActiveCount = 0;
+}
+
+AProjectilePool* AProjectilePool::Get(UWorld* World)
+{
+	// Only the server launches projectiles, the clients receive them
+	if ((World == NULL) || (World->GetNetMode() == NM_Client))
+	{
+		return NULL;
+	}
+
+	return GetWorldSingleton<AProjectilePool>(World);
+}
+
+void AProjectilePool::Prewarm(TSubclassOf<AProjectileBase> ProjectileClass, int32 Count)
+{
+	if (ProjectileClass == NULL)
+	{
+		return;
+	}
+
+	FProjectilePoolBucket& Bucket = this->FindOrAddBucket(ProjectileClass);
+
+	const int32 MissingCount = Count - (Bucket.FreeProjectiles.Num() + Bucket.ActiveCount);
+	for (int32 i = 0; i < MissingCount; i++)
+	{
+		AProjectileBase* Projectile = this->SpawnPooledProjectile(ProjectileClass);
+		if (Projectile != NULL)
+		{
+			Bucket.FreeProjectiles.Add(Projectile);
+		}
+	}
+}
+
+AProjectileBase* AProjectilePool::Acquire(TSubclassOf<AProjectileBase> ProjectileClass, const FVector& Location, const FRotator& Rotation, AController* Shooter)
+{
+	if (ProjectileClass == NULL)
+	{
+		return NULL;
+	}
+
+	FProjectilePoolBucket& Bucket = this->FindOrAddBucket(ProjectileClass);
+
+	AProjectileBase* Projectile = NULL;
+
+	// Projectiles destroyed from outside of the pool (e.g. in blueprints) are skipped
+	while ((Projectile == NULL) && (Bucket.FreeProjectiles.Num() > 0))
+	{
+		Projectile = Bucket.FreeProjectiles.Pop(false);
+
+		if ((Projectile != NULL) && Projectile->IsPendingKill())
+		{
+			Projectile = NULL;
+		}
+	}
+
+	if (Projectile != NULL)
+	{
+		this->PoolHits++;
+		INC_DWORD_STAT(STAT_ProjectilePoolHits);
+	}
+	else
+	{
+		Projectile = this->SpawnPooledProjectile(ProjectileClass);
+
+		if (Projectile == NULL)
+		{
+			return NULL;
+		}
+
+		this->PoolMisses++;
+		INC_DWORD_STAT(STAT_ProjectilePoolMisses);
+	}
+
+	Bucket.ActiveCount++;
+	this->ActiveCount++;
+	this->HighWaterMark = FMath::Max(this->HighWaterMark, this->ActiveCount);
+
+	SET_DWORD_STAT(STAT_ProjectilesInFlight, this->ActiveCount);
+	SET_DWORD_STAT(STAT_ProjectilesHighWaterMark, this->HighWaterMark);
+
+	Projectile->Launch(Location, Rotation, Shooter);
+
+	return Projectile;
+}
+
+void AProjectilePool::Release(AProjectileBase* Projectile)
+{
+	if ((Projectile == NULL) || !Projectile->bInFlight)
+	{
+		return;
+	}
+
+	Projectile->Deactivate();
+
+	FProjectilePoolBucket& Bucket = this->FindOrAddBucket(Projectile->GetClass());
+	Bucket.FreeProjectiles.Add(Projectile);
+	Bucket.ActiveCount = FMath::Max(Bucket.ActiveCount - 1, 0);
+
+	this->ActiveCount = FMath::Max(this->ActiveCount - 1, 0);
+	SET_DWORD_STAT(STAT_ProjectilesInFlight, this->ActiveCount);
+}
+
+FProjectilePoolBucket& AProjectilePool::FindOrAddBucket(TSubclassOf<AProjectileBase> ProjectileClass)
+{
+	for (FProjectilePoolBucket& Bucket : this->Buckets)
+	{
+		if (Bucket.ProjectileClass == ProjectileClass)
+		{
+			return Bucket;
+		}
+	}
+
+	const int32 Index = this->Buckets.AddDefaulted();
+	this->Buckets[Index].ProjectileClass = ProjectileClass;
+
+	return this->Buckets[Index];
+}
+
+AProjectileBase* AProjectilePool::SpawnPooledProjectile(TSubclassOf<AProjectileBase> ProjectileClass)
+{
+	FActorSpawnParameters ProjSpawnParams;
+	ProjSpawnParams.bNoCollisionFail = true;
+
+	AProjectileBase* Projectile = this->GetWorld()->SpawnActor<AProjectileBase>(ProjectileClass, this->GetActorLocation(), FRotator::ZeroRotator, ProjSpawnParams);
+
+	if (Projectile != NULL)
+	{
+		// The life span is handled by the pool (see AProjectileBase::Launch)
+		Projectile->SetLifeSpan(0.f);
+		Projectile->Deactivate();
+	}
+
+	return Projectile;
+}
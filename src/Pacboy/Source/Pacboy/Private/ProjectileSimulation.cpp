@@ -0,0 +1,324 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Pacboy.h"
+#include "ProjectileSimulation.h"
+#include "ProjectileBase.h"
+#include "NetRelevancyGrid.h"
+#include "WorldSingleton.h"
+
+DECLARE_CYCLE_STAT(TEXT("Batched Projectile Simulation"), STAT_BatchedProjectileSimulation, STATGROUP_Pacboy);
+DECLARE_CYCLE_STAT(TEXT("Batched Projectile Sweeps"), STAT_BatchedProjectileSweeps, STATGROUP_Pacboy);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Batched Projectiles"), STAT_BatchedProjectiles, STATGROUP_Pacboy);
+
+AProjectileSimulation::AProjectileSimulation(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	this->PrimaryActorTick.bCanEverTick = true;
+}
+
+AProjectileSimulation* AProjectileSimulation::Get(UWorld* World)
+{
+	return GetWorldSingleton<AProjectileSimulation>(World);
+}
+
+void AProjectileSimulation::Add(AProjectileBase* Projectile, const FVector& Location, const FVector& Velocity)
+{
+	const int32 Index = this->Projectiles.Add(Projectile);
+
+	this->Shooters.Add(Projectile->Shooter);
+	this->Positions.Add(Location);
+	this->PreviousPositions.Add(Location);
+	this->Velocities.Add(Velocity);
+	this->GravityZ.Add(this->GetWorld()->GetGravityZ() * Projectile->ProjectileMovement->ProjectileGravityScale);
+	this->Radii.Add(Projectile->CollisionComponent->GetScaledSphereRadius());
+	this->CollisionChannels.Add(Projectile->CollisionComponent->GetCollisionObjectType());
+	this->CollisionResponses.Add(FCollisionResponseParams(Projectile->CollisionComponent->GetCollisionResponseToChannels()));
+
+	Projectile->SimulationIndex = Index;
+
+	SET_DWORD_STAT(STAT_BatchedProjectiles, this->Projectiles.Num());
+}
+
+void AProjectileSimulation::Remove(AProjectileBase* Projectile)
+{
+	const int32 Index = Projectile->SimulationIndex;
+
+	if (!this->Projectiles.IsValidIndex(Index) || (this->Projectiles[Index] != Projectile))
+	{
+		return;
+	}
+
+	this->Projectiles.RemoveAtSwap(Index, 1, false);
+	this->Shooters.RemoveAtSwap(Index, 1, false);
+	this->Positions.RemoveAtSwap(Index, 1, false);
+	this->PreviousPositions.RemoveAtSwap(Index, 1, false);
+	this->Velocities.RemoveAtSwap(Index, 1, false);
+	this->GravityZ.RemoveAtSwap(Index, 1, false);
+	this->Radii.RemoveAtSwap(Index, 1, false);
+	this->CollisionChannels.RemoveAtSwap(Index, 1, false);
+	this->CollisionResponses.RemoveAtSwap(Index, 1, false);
+
+	// The last projectile was moved into the freed slot
+	if (this->Projectiles.IsValidIndex(Index))
+	{
+		this->Projectiles[Index]->SimulationIndex = Index;
+	}
+
+	Projectile->SimulationIndex = INDEX_NONE;
+
+	SET_DWORD_STAT(STAT_BatchedProjectiles, this->Projectiles.Num());
+}
+
+int32 AProjectileSimulation::Num() const
+{
+	return this->Projectiles.Num();
+}
+
+void AProjectileSimulation::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_BatchedProjectileSimulation);
+
+	if (this->Projectiles.Num() == 0)
+	{
+		return;
+	}
+
+	this->Integrate(DeltaTime);
+
+	this->SweepProjectiles();
+
+	ANetRelevancyGrid* RelevancyGrid = ANetRelevancyGrid::Get(this->GetWorld());
+
+	// Copy the simulated transforms back to the actors (used for rendering and replication)
+	for (int32 i = 0; i < this->Projectiles.Num(); i++)
+	{
+		this->Projectiles[i]->SetActorLocationAndRotation(this->Positions[i], this->Velocities[i].Rotation());
+		this->Projectiles[i]->CollisionComponent->ComponentVelocity = this->Velocities[i];
+
+		if (RelevancyGrid != NULL)
+		{
+			RelevancyGrid->UpdateActor(this->Projectiles[i]);
+		}
+	}
+
+	// Impacts return projectiles to the pool (which removes them from the arrays),
+	// so the projectiles are collected before any impact is processed
+	this->HitProjectiles.Reset();
+	for (int32 i = 0; i < this->HitIndices.Num(); i++)
+	{
+		this->HitProjectiles.Add(this->Projectiles[this->HitIndices[i]]);
+	}
+
+	for (int32 i = 0; i < this->HitProjectiles.Num(); i++)
+	{
+		this->HitProjectiles[i]->SetActorLocation(this->Hits[i].Location);
+		this->HitProjectiles[i]->ProcessBatchedHit(this->Hits[i]);
+	}
+
+	this->HitProjectiles.Reset();
+}
+
+void AProjectileSimulation::Integrate(float DeltaTime)
+{
+	const int32 Count = this->Positions.Num();
+
+	FMemory::Memcpy(this->PreviousPositions.GetData(), this->Positions.GetData(), Count * sizeof(FVector));
+
+	FVector* RESTRICT Position = this->Positions.GetData();
+	FVector* RESTRICT Velocity = this->Velocities.GetData();
+	const float* RESTRICT Gravity = this->GravityZ.GetData();
+
+	for (int32 i = 0; i < Count; i++)
+	{
+		Velocity[i].Z += Gravity[i] * DeltaTime;
+		Position[i] += Velocity[i] * DeltaTime;
+	}
+}
+
+void AProjectileSimulation::SweepProjectiles()
+{
+	SCOPE_CYCLE_COUNTER(STAT_BatchedProjectileSweeps);
+
+	this->HitIndices.Reset();
+	this->Hits.Reset();
+
+	UWorld* World = this->GetWorld();
+
+	FCollisionQueryParams QueryParams(FName(TEXT("ProjectileSweep")), false);
+
+	for (int32 i = 0; i < this->Positions.Num(); i++)
+	{
+		QueryParams.ClearIgnoredActors();
+		QueryParams.AddIgnoredActor(this->Projectiles[i]);
+
+		if ((this->Shooters[i] != NULL) && (this->Shooters[i]->GetPawn() != NULL))
+		{
+			QueryParams.AddIgnoredActor(this->Shooters[i]->GetPawn());
+		}
+
+		FHitResult Hit(ForceInit);
+
+		if (World->SweepSingle(Hit, this->PreviousPositions[i], this->Positions[i], FQuat::Identity, this->CollisionChannels[i], FCollisionShape::MakeSphere(this->Radii[i]), QueryParams, this->CollisionResponses[i]))
+		{
+			this->HitIndices.Add(i);
+			this->Hits.Add(Hit);
+		}
+	}
+}
+
+#if !UE_BUILD_SHIPPING
+
+/**
+* Spawns projectiles for the benchmark, in random directions, high above the level so that they don't hit anything
+* @param World - The world of the projectiles
+* @param Count - The number of projectiles
+* @param Random - The random stream of the locations and directions
+* @param OutProjectiles - Receives the projectiles
+*/
+static void SpawnBenchmarkProjectiles(UWorld* World, int32 Count, FRandomStream& Random, TArray<AProjectileBase*>& OutProjectiles)
+{
+	const FVector Center(0.f, 0.f, 200000.f);
+	const float Extent = 20000.f;
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.bNoCollisionFail = true;
+
+	for (int32 i = 0; i < Count; i++)
+	{
+		const FVector Location = Center + FVector(Random.FRandRange(-Extent, Extent), Random.FRandRange(-Extent, Extent), Random.FRandRange(-Extent, Extent));
+
+		AProjectileBase* Projectile = World->SpawnActor<AProjectileBase>(AProjectileBase::StaticClass(), Location, Random.GetUnitVector().Rotation(), SpawnParams);
+		if (Projectile != NULL)
+		{
+			// Only moved by the benchmark
+			Projectile->SetLifeSpan(0.f);
+			Projectile->ProjectileMovement->SetComponentTickEnabled(false);
+
+			OutProjectiles.Add(Projectile);
+		}
+	}
+}
+
+static void DestroyBenchmarkProjectiles(TArray<AProjectileBase*>& Projectiles)
+{
+	for (AProjectileBase* Projectile : Projectiles)
+	{
+		if (!Projectile->IsPendingKill())
+		{
+			Projectile->Destroy();
+		}
+	}
+
+	Projectiles.Reset();
+}
+
+/**
+* Compares the batched simulation with the projectile movement components of the projectiles:
+* moves the same number of projectiles for a number of frames with each and logs the time per frame
+*/
+static void ExecProjectileBenchmark(const TArray<FString>& Args)
+{
+	TArray<int32> Counts;
+	for (const FString& Arg : Args)
+	{
+		Counts.Add(FMath::Max(FCString::Atoi(*Arg), 1));
+	}
+
+	if (Counts.Num() == 0)
+	{
+		Counts.Add(100);
+		Counts.Add(1000);
+		Counts.Add(5000);
+	}
+
+	const int32 NumFrames = 60;
+	const float DeltaTime = 1.f / 60.f;
+
+	UWorld* World = NULL;
+
+	for (const FWorldContext& Context : GEngine->GetWorldContexts())
+	{
+		UWorld* ContextWorld = Context.World();
+		if ((ContextWorld != NULL) && ((Context.WorldType == EWorldType::Game) || (Context.WorldType == EWorldType::PIE)) && (ContextWorld->GetNetMode() != NM_Client))
+		{
+			World = ContextWorld;
+			break;
+		}
+	}
+
+	if (World == NULL)
+	{
+		UE_LOG(LogPacboy, Warning, TEXT("Projectile benchmark: no game world with authority"));
+		return;
+	}
+
+	UE_LOG(LogPacboy, Display, TEXT("Projectile benchmark, %d frames:"), NumFrames);
+
+	TArray<AProjectileBase*> Projectiles;
+
+	for (const int32 Count : Counts)
+	{
+		FRandomStream Random(Count);
+
+		// One projectile movement component tick per projectile and frame
+		SpawnBenchmarkProjectiles(World, Count, Random, Projectiles);
+
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 Frame = 0; Frame < NumFrames; Frame++)
+		{
+			for (AProjectileBase* Projectile : Projectiles)
+			{
+				UProjectileMovementComponent* Movement = Projectile->ProjectileMovement;
+				Movement->TickComponent(DeltaTime, LEVELTICK_All, &Movement->PrimaryComponentTick);
+			}
+		}
+		const double ComponentTime = FPlatformTime::Seconds() - StartTime;
+
+		DestroyBenchmarkProjectiles(Projectiles);
+
+		// A simulation of its own, so the projectiles of the game are not moved
+		AProjectileSimulation* Simulation = World->SpawnActor<AProjectileSimulation>();
+		if (Simulation == NULL)
+		{
+			return;
+		}
+
+		Random.Reset();
+		SpawnBenchmarkProjectiles(World, Count, Random, Projectiles);
+
+		for (AProjectileBase* Projectile : Projectiles)
+		{
+			Projectile->ProjectileMovement->Deactivate();
+			Projectile->SetActorEnableCollision(false);
+
+			Simulation->Add(Projectile, Projectile->GetActorLocation(), Projectile->GetActorRotation().Vector() * Projectile->ProjectileMovement->InitialSpeed);
+		}
+
+		StartTime = FPlatformTime::Seconds();
+		for (int32 Frame = 0; Frame < NumFrames; Frame++)
+		{
+			Simulation->Tick(DeltaTime);
+		}
+		const double SimulationTime = FPlatformTime::Seconds() - StartTime;
+
+		for (AProjectileBase* Projectile : Projectiles)
+		{
+			Simulation->Remove(Projectile);
+		}
+
+		DestroyBenchmarkProjectiles(Projectiles);
+		Simulation->Destroy();
+
+		UE_LOG(LogPacboy, Display, TEXT("  %d projectiles: movement components %.3f ms per frame, batched simulation %.3f ms per frame"),
+			Count, ComponentTime * 1000.0 / NumFrames, SimulationTime * 1000.0 / NumFrames);
+	}
+}
+
+static FAutoConsoleCommand ProjectileBenchmarkCommand(
+	TEXT("Pacboy.ProjectileBenchmark"),
+	TEXT("Compares the batched projectile simulation with the projectile movement components. Arguments: [NumProjectiles...] (100 1000 5000 by default)"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&ExecProjectileBenchmark));
+
+#endif
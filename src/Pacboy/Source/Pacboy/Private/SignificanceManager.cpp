@@ -0,0 +1,331 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Pacboy.h"
+#include "SignificanceManager.h"
+#include "CharacterBase.h"
+#include "WorldSingleton.h"
+#include "EngineUtils.h"
+
+DECLARE_CYCLE_STAT(TEXT("Significance Update"), STAT_SignificanceUpdate, STATGROUP_Pacboy);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Characters Of High Significance"), STAT_HighSignificanceCharacters, STATGROUP_Pacboy);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Characters Of Medium Significance"), STAT_MediumSignificanceCharacters, STATGROUP_Pacboy);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Characters Of Low Significance"), STAT_LowSignificanceCharacters, STATGROUP_Pacboy);
+
+static TAutoConsoleVariable<int32> CVarSignificance(
+	TEXT("Pacboy.Significance"),
+	1,
+	TEXT("Lowers the update rate of the characters that matter little to the local players.\n")
+	TEXT("0: All the characters are updated at full rate\n")
+	TEXT("1: On (default)"));
+
+ASignificanceManager::ASignificanceManager(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	this->PrimaryActorTick.bCanEverTick = true;
+
+	// Score the characters once they have moved and were drawn, the new settings are used from the next frame
+	this->PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+
+	this->MaxSignificanceDistance = 10000.f;
+	this->HiddenScoreScale = 0.25f;
+	this->RecentlyRenderedTime = 0.5f;
+	this->MinMediumScore = 0.1f;
+	this->MaxHighSignificance = 8;
+	this->MaxMediumSignificance = 8;
+	this->MediumTickInterval = 0.1f;
+	this->LowTickInterval = 0.25f;
+}
+
+ASignificanceManager* ASignificanceManager::Get(UWorld* World)
+{
+	if (!ShouldPlayCosmetics(World))
+	{
+		return NULL;
+	}
+
+	return GetWorldSingleton<ASignificanceManager>(World);
+}
+
+void ASignificanceManager::RegisterCharacter(ACharacterBase* Character)
+{
+	if (Character != NULL)
+	{
+		this->Characters.AddUnique(Character);
+	}
+}
+
+void ASignificanceManager::UnregisterCharacter(ACharacterBase* Character)
+{
+	this->Characters.RemoveSingleSwap(Character);
+	this->ScoredCharacters.RemoveSingleSwap(Character);
+}
+
+void ASignificanceManager::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	SCOPE_CYCLE_COUNTER(STAT_SignificanceUpdate);
+
+	this->ViewLocations.Reset();
+	this->ViewDirections.Reset();
+
+	for (FConstPlayerControllerIterator It = this->GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = *It;
+
+		if ((PlayerController != NULL) && PlayerController->IsLocalController())
+		{
+			FVector ViewLocation;
+			FRotator ViewRotation;
+			PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+			this->ViewLocations.Add(ViewLocation);
+			this->ViewDirections.Add(ViewRotation.Vector());
+		}
+	}
+
+	const bool bEnabled = (CVarSignificance.GetValueOnGameThread() != 0) && (this->ViewLocations.Num() > 0);
+
+	this->ScoredCharacters.Reset();
+
+	for (ACharacterBase* Character : this->Characters)
+	{
+		if ((Character == NULL) || Character->IsPendingKill())
+		{
+			continue;
+		}
+
+		// The locally controlled characters and the characters simulated by this world always run at full rate
+		if (!bEnabled || (Character->Role != ROLE_SimulatedProxy))
+		{
+			this->ApplySignificance(Character, ECharacterSignificance::High);
+			continue;
+		}
+
+		Character->SignificanceScore = this->ScoreCharacter(Character);
+		this->ScoredCharacters.Add(Character);
+	}
+
+	this->ScoredCharacters.Sort([](const ACharacterBase& A, const ACharacterBase& B)
+	{
+		return A.SignificanceScore > B.SignificanceScore;
+	});
+
+	int32 HighCount = 0;
+	int32 MediumCount = 0;
+	int32 LowCount = 0;
+
+	for (ACharacterBase* Character : this->ScoredCharacters)
+	{
+		const bool bSignificant = (Character->SignificanceScore >= this->MinMediumScore);
+
+		if (bSignificant && (HighCount < this->MaxHighSignificance))
+		{
+			this->ApplySignificance(Character, ECharacterSignificance::High);
+			HighCount++;
+		}
+		else if (bSignificant && (MediumCount < this->MaxMediumSignificance))
+		{
+			this->ApplySignificance(Character, ECharacterSignificance::Medium);
+			MediumCount++;
+		}
+		else
+		{
+			this->ApplySignificance(Character, ECharacterSignificance::Low);
+			LowCount++;
+		}
+	}
+
+	SET_DWORD_STAT(STAT_HighSignificanceCharacters, HighCount);
+	SET_DWORD_STAT(STAT_MediumSignificanceCharacters, MediumCount);
+	SET_DWORD_STAT(STAT_LowSignificanceCharacters, LowCount);
+}
+
+float ASignificanceManager::ScoreCharacter(const ACharacterBase* Character) const
+{
+	const FVector Location = Character->GetActorLocation();
+
+	const USkeletalMeshComponent* Mesh = Character->GetMesh();
+	const bool bRecentlyRendered = (Mesh != NULL) && (this->GetWorld()->GetTimeSeconds() - Mesh->LastRenderTime <= this->RecentlyRenderedTime);
+
+	float BestScore = 0.f;
+
+	for (int32 i = 0; i < this->ViewLocations.Num(); i++)
+	{
+		const FVector Offset = Location - this->ViewLocations[i];
+
+		float Score = 1.f - FMath::Clamp(Offset.Size() / this->MaxSignificanceDistance, 0.f, 1.f);
+
+		if (!bRecentlyRendered || (FVector::DotProduct(Offset, this->ViewDirections[i]) < 0.f))
+		{
+			Score *= this->HiddenScoreScale;
+		}
+
+		BestScore = FMath::Max(BestScore, Score);
+	}
+
+	return BestScore;
+}
+
+void ASignificanceManager::ApplySignificance(ACharacterBase* Character, ECharacterSignificance::Type Significance) const
+{
+	float TickInterval = 0.f;
+
+	if (Significance == ECharacterSignificance::Medium)
+	{
+		TickInterval = this->MediumTickInterval;
+	}
+	else if (Significance == ECharacterSignificance::Low)
+	{
+		TickInterval = this->LowTickInterval;
+	}
+
+	Character->SetSignificance(Significance, TickInterval);
+}
+
+#if !UE_BUILD_SHIPPING
+
+/** The state of the significance benchmark, which runs over the next frames (see ExecSignificanceBenchmark) */
+struct FSignificanceBenchmark
+{
+	/** The frames measured with the significance off, then on */
+	int32 NumFrames;
+
+	/** The frames skipped after switching the significance (the settings of the characters change over a frame) */
+	int32 NumWarmUpFrames;
+
+	/** The frame of the current pass, warm up included */
+	int32 Frame;
+
+	/** The current pass (0: significance off, 1: on) */
+	int32 Pass;
+
+	/** The total frame time and game thread time of each pass */
+	double FrameTime[2];
+	double GameThreadTime[2];
+
+	/** The value of Pacboy.Significance before the benchmark */
+	int32 PreviousSignificance;
+
+	/** The simulated characters when the benchmark started */
+	int32 NumCharacters;
+
+	/** The ticker of the benchmark */
+	FTickerDelegate Ticker;
+};
+
+static FSignificanceBenchmark SignificanceBenchmark;
+
+static bool TickSignificanceBenchmark(float DeltaTime)
+{
+	FSignificanceBenchmark& Benchmark = SignificanceBenchmark;
+
+	if (Benchmark.Frame >= Benchmark.NumWarmUpFrames)
+	{
+		Benchmark.FrameTime[Benchmark.Pass] += DeltaTime;
+		Benchmark.GameThreadTime[Benchmark.Pass] += FPlatformTime::ToSeconds(GGameThreadTime);
+	}
+
+	Benchmark.Frame++;
+
+	if (Benchmark.Frame < Benchmark.NumWarmUpFrames + Benchmark.NumFrames)
+	{
+		return true;
+	}
+
+	Benchmark.Frame = 0;
+	Benchmark.Pass++;
+
+	if (Benchmark.Pass == 1)
+	{
+		CVarSignificance.AsVariable()->Set(TEXT("1"));
+		return true;
+	}
+
+	CVarSignificance.AsVariable()->Set(*FString::FromInt(Benchmark.PreviousSignificance));
+
+	const double FrameTimeOff = Benchmark.FrameTime[0] * 1000.0 / Benchmark.NumFrames;
+	const double FrameTimeOn = Benchmark.FrameTime[1] * 1000.0 / Benchmark.NumFrames;
+	const double GameThreadTimeOff = Benchmark.GameThreadTime[0] * 1000.0 / Benchmark.NumFrames;
+	const double GameThreadTimeOn = Benchmark.GameThreadTime[1] * 1000.0 / Benchmark.NumFrames;
+
+	UE_LOG(LogPacboy, Display, TEXT("Significance benchmark, %d simulated characters, average of %d frames:"), Benchmark.NumCharacters, Benchmark.NumFrames);
+	UE_LOG(LogPacboy, Display, TEXT("  Significance off: frame %.3f ms, game thread %.3f ms"), FrameTimeOff, GameThreadTimeOff);
+	UE_LOG(LogPacboy, Display, TEXT("  Significance on: frame %.3f ms, game thread %.3f ms"), FrameTimeOn, GameThreadTimeOn);
+	UE_LOG(LogPacboy, Display, TEXT("  Saved: frame %.3f ms, game thread %.3f ms"), FrameTimeOff - FrameTimeOn, GameThreadTimeOff - GameThreadTimeOn);
+
+	Benchmark.Ticker.Unbind();
+	return false;
+}
+
+/**
+* Measures the frame time saved by the significance manager on the game world of this process, by running
+* the same number of frames with the significance off and then on. Only the simulated characters are affected,
+* so the benchmark is run on a client of a match (e.g. 32 characters with 31 bot clients, see APacboyBotDriver),
+* without moving the camera
+*/
+static void ExecSignificanceBenchmark(const TArray<FString>& Args)
+{
+	FSignificanceBenchmark& Benchmark = SignificanceBenchmark;
+
+	if (Benchmark.Ticker.IsBound())
+	{
+		UE_LOG(LogPacboy, Warning, TEXT("Significance benchmark: already running"));
+		return;
+	}
+
+	UWorld* World = NULL;
+
+	for (const FWorldContext& Context : GEngine->GetWorldContexts())
+	{
+		UWorld* ContextWorld = Context.World();
+		if ((ContextWorld != NULL) && ((Context.WorldType == EWorldType::Game) || (Context.WorldType == EWorldType::PIE)) && (ASignificanceManager::Get(ContextWorld) != NULL))
+		{
+			World = ContextWorld;
+			break;
+		}
+	}
+
+	if (World == NULL)
+	{
+		UE_LOG(LogPacboy, Warning, TEXT("Significance benchmark: no game world with cosmetic effects"));
+		return;
+	}
+
+	Benchmark.NumCharacters = 0;
+	for (TActorIterator<ACharacterBase> It(World); It; ++It)
+	{
+		if (It->Role == ROLE_SimulatedProxy)
+		{
+			Benchmark.NumCharacters++;
+		}
+	}
+
+	if (Benchmark.NumCharacters == 0)
+	{
+		UE_LOG(LogPacboy, Warning, TEXT("Significance benchmark: no simulated characters (run it on a client)"));
+		return;
+	}
+
+	Benchmark.NumFrames = (Args.Num() > 0) ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 600;
+	Benchmark.NumWarmUpFrames = 30;
+	Benchmark.Frame = 0;
+	Benchmark.Pass = 0;
+	Benchmark.FrameTime[0] = Benchmark.FrameTime[1] = 0.0;
+	Benchmark.GameThreadTime[0] = Benchmark.GameThreadTime[1] = 0.0;
+	Benchmark.PreviousSignificance = CVarSignificance.GetValueOnGameThread();
+
+	CVarSignificance.AsVariable()->Set(TEXT("0"));
+
+	Benchmark.Ticker = FTickerDelegate::CreateStatic(&TickSignificanceBenchmark);
+	FTicker::GetCoreTicker().AddTicker(Benchmark.Ticker);
+
+	UE_LOG(LogPacboy, Display, TEXT("Significance benchmark: measuring %d frames with the significance off, then on"), Benchmark.NumFrames);
+}
+
+static FAutoConsoleCommand SignificanceBenchmarkCommand(
+	TEXT("Pacboy.SignificanceBenchmark"),
+	TEXT("Measures the frame time saved by the significance of the simulated characters, on a client. Arguments: [NumFrames] (600 by default)"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&ExecSignificanceBenchmark));
+
+#endif
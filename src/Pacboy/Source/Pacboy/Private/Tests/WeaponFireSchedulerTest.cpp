@@ -0,0 +1,131 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Pacboy.h"
+#include "Weapon.h"
+
+#if !UE_BUILD_SHIPPING
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FWeaponFireSchedulerTest, "Pacboy.Weapon.FireScheduler", EAutomationTestFlags::ATF_Editor | EAutomationTestFlags::ATF_Game)
+
+bool FWeaponFireSchedulerTest::RunTest(const FString& Parameters)
+{
+	bool bSuccess = true;
+
+	// The number of shots fired while the fire input is held must only depend on the rate of fire
+	const int32 TickRates[] = { 20, 30, 60, 90, 120 };
+	const int32 ShotsPerSecondValues[] = { 1, 5, 10, 13, 30, 60 };
+	// The float times lose precision as they grow, a long session must fire the same shots
+	const float StartTimes[] = { 0.f, 1000.f, 10000.f };
+	const int32 Duration = 10;
+
+	for (int32 TickRateIndex = 0; TickRateIndex < ARRAY_COUNT(TickRates); TickRateIndex++)
+	{
+		for (int32 RateIndex = 0; RateIndex < ARRAY_COUNT(ShotsPerSecondValues); RateIndex++)
+		{
+			for (int32 StartTimeIndex = 0; StartTimeIndex < ARRAY_COUNT(StartTimes); StartTimeIndex++)
+			{
+				const int32 TickRate = TickRates[TickRateIndex];
+				const int32 ShotsPerSecond = ShotsPerSecondValues[RateIndex];
+				const float StartTime = StartTimes[StartTimeIndex];
+
+				const float DeltaTime = 1.f / TickRate;
+				const float ShotInterval = 1.f / ShotsPerSecond;
+
+				FWeaponFireScheduler Scheduler;
+				Scheduler.Arm(StartTime);
+
+				int32 NumShots = 0;
+				bool bShotLate = false;
+
+				for (int32 Frame = 0; Frame <= Duration * TickRate; Frame++)
+				{
+					const float Time = StartTime + Frame * DeltaTime;
+
+					float FirstShotAge;
+					const int32 NumFrameShots = Scheduler.Advance(Time, ShotInterval, FirstShotAge);
+
+					if (NumFrameShots > 0)
+					{
+						// The shots keep their own times, however the frames fall (measured from the start to keep the precision)
+						const float FirstShotOffset = (Time - StartTime) - FirstShotAge;
+						bShotLate |= !FMath::IsNearlyEqual(FirstShotOffset, NumShots * ShotInterval, 0.001f);
+					}
+
+					NumShots += NumFrameShots;
+				}
+
+				// The first shot is fired when the weapon is armed, then one every ShotInterval up to the end
+				const int32 ExpectedNumShots = Duration * ShotsPerSecond + 1;
+
+				if (NumShots != ExpectedNumShots)
+				{
+					AddError(FString::Printf(TEXT("%d shots/s at %d Hz (from %.0f s): %d shots in %d s, expected %d"), ShotsPerSecond, TickRate, StartTime, NumShots, Duration, ExpectedNumShots));
+					bSuccess = false;
+				}
+
+				if (bShotLate)
+				{
+					AddError(FString::Printf(TEXT("%d shots/s at %d Hz (from %.0f s): the shot times drifted"), ShotsPerSecond, TickRate, StartTime));
+					bSuccess = false;
+				}
+			}
+		}
+	}
+
+	// A long hitch fires at most MaxShotsPerAdvance shots, and the shots after it are not owed
+	{
+		const float ShotInterval = 0.1f;
+		const float HitchTime = 10.f;
+
+		FWeaponFireScheduler Scheduler;
+		Scheduler.Arm(0.f);
+
+		float FirstShotAge;
+		const int32 NumFirstShots = Scheduler.Advance(0.f, ShotInterval, FirstShotAge);
+		const int32 NumHitchShots = Scheduler.Advance(HitchTime, ShotInterval, FirstShotAge);
+		const float HitchFirstShotAge = FirstShotAge;
+		const int32 NumNextShots = Scheduler.Advance(HitchTime + 0.5f * ShotInterval, ShotInterval, FirstShotAge);
+
+		if ((NumFirstShots != 1) || (NumHitchShots != FWeaponFireScheduler::MaxShotsPerAdvance) || (NumNextShots != 0))
+		{
+			AddError(FString::Printf(TEXT("Hitch: %d, %d and %d shots, expected 1, %d and 0"), NumFirstShots, NumHitchShots, NumNextShots, FWeaponFireScheduler::MaxShotsPerAdvance));
+			bSuccess = false;
+		}
+
+		// The shots of the hitch are the last ones that were due
+		const float ExpectedFirstShotAge = ShotInterval * (FWeaponFireScheduler::MaxShotsPerAdvance - 1);
+		if (!FMath::IsNearlyEqual(HitchFirstShotAge, ExpectedFirstShotAge, 0.001f))
+		{
+			AddError(FString::Printf(TEXT("Hitch: the first shot is %f s old, expected %f s"), HitchFirstShotAge, ExpectedFirstShotAge));
+			bSuccess = false;
+		}
+	}
+
+	// A disarmed weapon fires nothing, and arming it again during the cool down waits for it
+	{
+		const float ShotInterval = 0.5f;
+
+		FWeaponFireScheduler Scheduler;
+		Scheduler.Arm(0.f);
+
+		float FirstShotAge;
+		Scheduler.Advance(0.f, ShotInterval, FirstShotAge);
+		Scheduler.Disarm();
+
+		const int32 NumDisarmedShots = Scheduler.Advance(1.f, ShotInterval, FirstShotAge);
+
+		Scheduler.Arm(0.1f);
+		const int32 NumCoolDownShots = Scheduler.Advance(0.1f, ShotInterval, FirstShotAge);
+		const int32 NumRearmedShots = Scheduler.Advance(0.5f, ShotInterval, FirstShotAge);
+
+		if ((NumDisarmedShots != 0) || (NumCoolDownShots != 0) || (NumRearmedShots != 1))
+		{
+			AddError(FString::Printf(TEXT("Re-arm: %d, %d and %d shots, expected 0, 0 and 1"), NumDisarmedShots, NumCoolDownShots, NumRearmedShots));
+			bSuccess = false;
+		}
+	}
+
+	return bSuccess;
+}
+
+#endif
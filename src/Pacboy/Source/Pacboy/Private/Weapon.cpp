@@ -3,35 +3,110 @@
 #include "Pacboy.h"
 #include "Weapon.h"
 
+FWeaponFireScheduler::FWeaponFireScheduler()
+	: bArmed(false)
+	, TimeToNextShot(0.f)
+	, LastUpdateTime(0.f)
+{
+}
+
+void FWeaponFireScheduler::Arm(float Time)
+{
+	if (this->bArmed)
+	{
+		return;
+	}
+
+	// The cool down of the last shot went on while the weapon was disarmed
+	this->bArmed = true;
+	this->TimeToNextShot = FMath::Max(this->TimeToNextShot - (Time - this->LastUpdateTime), 0.f);
+	this->LastUpdateTime = Time;
+}
+
+void FWeaponFireScheduler::Disarm()
+{
+	this->bArmed = false;
+}
+
+bool FWeaponFireScheduler::IsArmed() const
+{
+	return this->bArmed;
+}
+
+int32 FWeaponFireScheduler::Advance(float Time, float ShotInterval, float& OutFirstShotAge)
+{
+	// The shot intervals are accumulated in floats, so a shot due at the current time may be computed
+	// a fraction of a millisecond after it. It is still fired in this update instead of the next one (in seconds)
+	const float DueTolerance = 0.0001f;
+
+	if (!this->bArmed)
+	{
+		return 0;
+	}
+
+	// Only the time since the last update is subtracted, so the precision doesn't depend on how large the time is
+	this->TimeToNextShot -= Time - this->LastUpdateTime;
+	this->LastUpdateTime = Time;
+
+	// The shots that are too late are dropped
+	this->TimeToNextShot = FMath::Max(this->TimeToNextShot, -ShotInterval * (MaxShotsPerAdvance - 1));
+
+	if (this->TimeToNextShot > DueTolerance)
+	{
+		return 0;
+	}
+
+	const int32 NumShots = FMath::Min(FMath::FloorToInt((DueTolerance - this->TimeToNextShot) / ShotInterval) + 1, (int32)MaxShotsPerAdvance);
+
+	OutFirstShotAge = -this->TimeToNextShot;
+	this->TimeToNextShot += NumShots * ShotInterval;
+
+	return NumShots;
+}
+
 AWeapon::AWeapon(const FObjectInitializer& ObjectInitializer)
 	: Super(ObjectInitializer)
 {
 	this->WeaponMesh = ObjectInitializer.CreateDefaultSubobject<USkeletalMeshComponent>(this, FName(TEXT("WeaponMesh")));
 
+	// The weapon is relevant whenever the character holding it is
+	this->bNetUseOwnerRelevancy = true;
+
+	this->Definition = NULL;
+	this->RemainingAmmo = 0;
+	this->AmmoInClip = 0;
+
+	this->WeaponType_DEPRECATED = EWeaponType::Rifle;
+	this->ShootingType_DEPRECATED = EWeaponShootingType::Instant;
+	this->Damage_DEPRECATED = 0.f;
+	this->AmmoCapacity_DEPRECATED = 0;
+	this->ClipCapacity_DEPRECATED = 0;
+	this->GunMuzzleSocketName_DEPRECATED = NAME_None;
+	this->ShotsPerSecond_DEPRECATED = 0;
+	this->WeaponImpactFX_DEPRECATED = NULL;
+	this->WeaponShotFX_DEPRECATED = NULL;
+	this->WeaponShotSFX_DEPRECATED = NULL;
+
 	// Note: The static mesh references on the WeaponMesh component
 	// are set in the derived blueprint classes (to avoid direct content references in C++)
 }
 
-void AWeapon::Init(const AWeapon& Weapon)
+void AWeapon::Init()
 {
-	this->WeaponType = Weapon.WeaponType;
-	this->ShootingType = Weapon.ShootingType;
-	this->Damage = Weapon.Damage;
-	this->AmmoCapacity = Weapon.AmmoCapacity;
-	this->ClipCapacity = Weapon.ClipCapacity;
-	this->RemainingAmmo = Weapon.RemainingAmmo;
-	this->AmmoInClip = Weapon.AmmoInClip;
-	this->GunMuzzleSocketName = Weapon.GunMuzzleSocketName;
-	this->ShotsPerSecond = Weapon.ShotsPerSecond;
-	this->ProjectileClass = Weapon.ProjectileClass;
-	this->WeaponImpactFX = Weapon.WeaponImpactFX;
+	const UWeaponDefinition* WeaponDefinition = this->GetDefinition();
+
+	this->RemainingAmmo = WeaponDefinition->InitialRemainingAmmo;
+	this->AmmoInClip = WeaponDefinition->InitialAmmoInClip;
+	this->FireScheduler.Disarm();
 }
 
 void AWeapon::Reload()
 {
-	if ((this->AmmoInClip < this->ClipCapacity) && (this->RemainingAmmo > 0))
+	const int32 ClipCapacity = this->GetDefinition()->ClipCapacity;
+
+	if ((this->AmmoInClip < ClipCapacity) && (this->RemainingAmmo > 0))
 	{
-		int32 AmmoToReload = this->ClipCapacity - this->AmmoInClip;
+		int32 AmmoToReload = ClipCapacity - this->AmmoInClip;
 
 		if (this->RemainingAmmo > AmmoToReload)
 		{
@@ -45,3 +120,42 @@ void AWeapon::Reload()
 		}
 	}
 }
+
+float AWeapon::GetShotInterval() const
+{
+	return this->GetDefinition()->GetShotInterval();
+}
+
+void AWeapon::PostLoad()
+{
+	Super::PostLoad();
+
+	if (this->Definition != NULL)
+	{
+		return;
+	}
+
+	// The definition is made a subobject of the weapon (the class default object for the blueprints),
+	// so it is shared by the spawned weapons and saved with the blueprint the next time it is saved
+	UWeaponDefinition* LegacyDefinition = ConstructObject<UWeaponDefinition>(UWeaponDefinition::StaticClass(), this, FName(TEXT("LegacyDefinition")));
+
+	LegacyDefinition->WeaponType = this->WeaponType_DEPRECATED;
+	LegacyDefinition->ShootingType = this->ShootingType_DEPRECATED;
+	LegacyDefinition->Damage = this->Damage_DEPRECATED;
+	LegacyDefinition->AmmoCapacity = this->AmmoCapacity_DEPRECATED;
+	LegacyDefinition->ClipCapacity = this->ClipCapacity_DEPRECATED;
+	LegacyDefinition->GunMuzzleSocketName = this->GunMuzzleSocketName_DEPRECATED;
+	LegacyDefinition->ShotsPerSecond = this->ShotsPerSecond_DEPRECATED;
+	LegacyDefinition->ProjectileClass = this->ProjectileClass_DEPRECATED;
+	LegacyDefinition->WeaponImpactFX = this->WeaponImpactFX_DEPRECATED;
+	LegacyDefinition->WeaponShotFX = this->WeaponShotFX_DEPRECATED;
+	LegacyDefinition->WeaponShotSFX = this->WeaponShotSFX_DEPRECATED;
+
+	// The new weapons used to copy the ammo of the class default object
+	LegacyDefinition->InitialRemainingAmmo = this->RemainingAmmo;
+	LegacyDefinition->InitialAmmoInClip = this->AmmoInClip;
+
+	this->Definition = LegacyDefinition;
+
+	UE_LOG(LogPacboy, Warning, TEXT("%s has no weapon definition, one was made from its legacy properties"), *this->GetName());
+}
@@ -0,0 +1,27 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Pacboy.h"
+#include "WeaponDefinition.h"
+
+UWeaponDefinition::UWeaponDefinition(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	this->WeaponType = EWeaponType::Rifle;
+	this->ShootingType = EWeaponShootingType::Instant;
+	this->Damage = 0.f;
+	this->Range = 10000.f;
+	this->AmmoCapacity = 0;
+	this->ClipCapacity = 0;
+	this->InitialRemainingAmmo = 0;
+	this->InitialAmmoInClip = 0;
+	this->GunMuzzleSocketName = NAME_None;
+	this->ShotsPerSecond = 1;
+	this->WeaponImpactFX = NULL;
+	this->WeaponShotFX = NULL;
+	this->WeaponShotSFX = NULL;
+}
+
+float UWeaponDefinition::GetShotInterval() const
+{
+	return 1.f / FMath::Max(this->ShotsPerSecond, 1);
+}
@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Components/ActorComponent.h"
+#include "AimCameraComponent.generated.h"
+
+/**
+* Moves the camera booms of a character to the lengths of its aiming state.
+* The transition only ticks on the locally controlled character, from the moment the aiming state
+* changes until the booms reach their lengths. The server moves the booms without transition
+* (the shots start from the camera) and the other characters don't move their camera at all.
+*/
+UCLASS()
+class PACBOY_API UAimCameraComponent : public UActorComponent
+{
+public:
+
+	/** The camera booms are considered at their target lengths when closer than this */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Camera")
+	float ConvergenceTolerance;
+
+	UAimCameraComponent(const FObjectInitializer& ObjectInitializer);
+
+	/**
+	* Sets the camera booms moved by the component
+	* @param InCameraBoom - The camera boom
+	* @param InCameraBoomExtension - The extension of the camera boom
+	*/
+	void SetCameraBooms(USpringArmComponent* InCameraBoom, USpringArmComponent* InCameraBoomExtension);
+
+	/**
+	* Starts moving the camera booms to new lengths
+	* @param CameraBoomLength - The target length of the camera boom
+	* @param CameraBoomExtensionLength - The target length of the camera boom extension
+	* @param SmoothSpeed - The smooth speed of the transition (a multiplier for DeltaTime)
+	*/
+	void MoveTo(float CameraBoomLength, float CameraBoomExtensionLength, float SmoothSpeed);
+
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction) override;
+
+private:
+
+	/** The camera boom */
+	UPROPERTY()
+	USpringArmComponent* CameraBoom;
+
+	/** The extension of the camera boom */
+	UPROPERTY()
+	USpringArmComponent* CameraBoomExtension;
+
+	/** The target length of the camera boom */
+	float TargetCameraBoomLength;
+
+	/** The target length of the camera boom extension */
+	float TargetCameraBoomExtensionLength;
+
+	/** The smooth speed of the current transition */
+	float TransitionSmoothSpeed;
+
+	/** Sets the camera booms to their target lengths */
+	void SnapToTarget();
+
+	GENERATED_BODY()
+
+};
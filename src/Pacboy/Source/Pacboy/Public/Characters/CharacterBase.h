@@ -4,6 +4,13 @@
 
 #include "DamageableObject.h"
 #include "GameFramework/Character.h"
+#include "CharacterReplicatedState.h"
+#include "FireCommand.h"
+#include "GameplayTimers.h"
+#include "HitDescriptor.h"
+#include "LagCompensationComponent.h"
+#include "PacboyCharacterMovement.h"
+#include "SignificanceManager.h"
 #include "Weapon.h"
 #include "MainPlayerController.h"
 #include "CharacterBase.generated.h"
@@ -29,15 +36,18 @@ public:
 	float AimSpeed;
 
 	/** The Current health that the character has left */
-	UPROPERTY(BlueprintReadOnly, Replicated, Category = "Character")
+	UPROPERTY(BlueprintReadOnly, Category = "Character")
 	float Health;
 
 	/** The maximum health of the character that he can have */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadWrite, Category = "Character")
 	float HealthCapacity;
 
-	/** The current energy that the character has left */
-	UPROPERTY(BlueprintReadOnly, Replicated, Category = "Character")
+	/**
+	* The current energy that the character has left.
+	* Only refreshed every frame for the locally controlled character (use GetEnergy otherwise)
+	*/
+	UPROPERTY(BlueprintReadOnly, Category = "Character")
 	float Energy;
 
 	/** The maximum energy that the character can have */
@@ -45,28 +55,25 @@ public:
 	float EnergyCapacity;
 
 	/** Indicates if the character is sprinting */
-	UPROPERTY(BlueprintReadOnly, Replicated, Category = "Character")
+	UPROPERTY(BlueprintReadOnly, Category = "Character")
 	bool bIsSprinting;
 
 	/** Indicates if the character is aiming */
-	UPROPERTY(BlueprintReadOnly, Replicated, Category = "Character")
+	UPROPERTY(BlueprintReadOnly, Category = "Character")
 	bool bIsAiming;
 
 	/** Indicates if the character is firing */
-	UPROPERTY(BlueprintReadOnly, Replicated, Category = "Character")
+	UPROPERTY(BlueprintReadOnly, Category = "Character")
 	bool bIsFiring;
 
 	/** Indicates if the character is reloading */
-	UPROPERTY(BlueprintReadOnly, Replicated, Category = "Character")
+	UPROPERTY(BlueprintReadOnly, Category = "Character")
 	bool bIsReloading;
 
 	/** Indicates if the character is dead */
-	UPROPERTY(BlueprintReadOnly, Replicated, Category = "Character")
+	UPROPERTY(BlueprintReadOnly, Category = "Character")
 	bool bIsDead;
 
-	UPROPERTY(Replicated)
-	bool bReloadClient;
-
 	/** Character dash force */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Character Movement")
 	float DashForce;
@@ -122,35 +129,38 @@ public:
 	UPROPERTY(EditDefaultsOnly, Category = "Animations")
 	UAnimMontage* ReloadAnim;
 
-	UPROPERTY(Replicated)
-	float ReloadAnimTimeRemaining;
+	/** Records the recent poses of the character (on the server) to check the hits reported by clients */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Character")
+	ULagCompensationComponent* LagCompensation;
 
-	UPROPERTY(Replicated)
-	bool FirstShot;
+	/** The maximum time (in seconds) that the targets of a shot are rewound by */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	float MaxLagCompensation;
 
-	UPROPERTY(Replicated)
-	bool DelayShot;
+	/** Used for aim offset */
+	UPROPERTY()
+	float CharPitch;
 
-	UPROPERTY(Replicated)
-	bool ShootingGateOpen;
+	/** The significance of the character for the local players (see ASignificanceManager) */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = "Significance")
+	TEnumAsByte<ECharacterSignificance::Type> Significance;
 
-	UPROPERTY(Replicated)
-	bool FireFromClient;
+	/** The significance score of the character for the local players, from 0 to 1 (see ASignificanceManager) */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = "Significance")
+	float SignificanceScore;
 
-	/** Used for aim offset */
-	UPROPERTY(Replicated)
-	float CharPitch;
+	/** The replicated state of the character (Health, Energy, state flags, etc. packed together) */
+	UPROPERTY(ReplicatedUsing = OnRep_ReplicatedState)
+	FCharacterReplicatedState ReplicatedState;
 
 	UFUNCTION(Server, WithValidation, Reliable)
 	void SetCharPitch_Server();
 
-	UFUNCTION(Server, WithValidation, Reliable)
-	void RestartReloadAnimTimeRemaining();
-
 	ACharacterBase(const FObjectInitializer& ObjectInitializer);
 
 	/**
-	* The character takes damage
+	* The character takes damage. The damage is queued and applied with the other hits
+	* of the frame (see ADamageQueue). Does nothing on the clients
 	* @param Damage - How much damage the character gets
 	* @param Hit - Hit information
 	* @param EventInstigator - The Controller responsible for the damage
@@ -158,11 +168,24 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Character Action")
 	virtual void TakeDamage(float Damage, const FHitResult& Hit, AController* EventInstigator) override;
 
-	UFUNCTION(Server, WithValidation, Reliable)
-	virtual void TakeDamage_Server(float Damage, const FHitResult& Hit, AController* EventInstigator);
+	/** Applies the hits of the frame, plays one hit effect and kills the character once if it runs out of health */
+	virtual void ApplyQueuedDamage(const TArray<FQueuedHit>& Hits) override;
 
-	UFUNCTION(NetMulticast, Reliable)
-	virtual void TakeDamageFX_Multicast(FVector ImpactPoint);
+	/**
+	* Makes the descriptor of a hit of this character's next shot, sent with its fire command (see QueueFireCommand)
+	* @param Hit - The hit of the shot
+	*/
+	FHitDescriptor MakeHitDescriptor(const FHitResult& Hit) const;
+
+	/**
+	* Checks a hitscan hit reported with a fire command against the shot, the static world and the pose
+	* of the target at the time the shooter saw it, and applies the damage (on the server)
+	* @param Command - The shot and its hit
+	*/
+	virtual void ConfirmHit(const FFireCommand& Command);
+
+	/** Returns the server time at which the player of this character saw the world when shooting */
+	float GetLagCompensatedTime() const;
 
 	UFUNCTION(Client, Reliable)
 	virtual void TakeDamage_Client();
@@ -170,19 +193,34 @@ public:
 	/** Called when character receives any damage (from ingame events) */
 	virtual void ReceiveAnyDamage(float Damage, const class UDamageType* DamageType, class AController* InstigatedBy, AActor* DamageCauser) override;
 
-	UFUNCTION(NetMulticast, WithValidation, Reliable, Category = "Weapon Action")
-	void OnFireEvent_Multicast(FVector Location);
+	/**
+	* Sends a cosmetic event to the players that can see it (see ACosmeticEventRelay).
+	* Played right away when called on a client
+	* @param Type - The type of the event
+	* @param Location - The location of the event
+	*/
+	void QueueCosmeticEvent(ECosmeticEventType::Type Type, const FVector& Location);
+
+	/** Plays the shot effects of the equipped weapon */
+	virtual void PlayFireFX(const FVector& Location);
 
-	UFUNCTION(Server, WithValidation, Reliable)
-	void OnReloadStart_Server();
+	/** Plays the impact effect of the equipped weapon */
+	virtual void PlayImpactFX(const FVector& ImpactPoint);
 
-	UFUNCTION(NetMulticast, Reliable)
-	void OnReloadStart_Multicast();
+	/** Plays the effect of the character being hit */
+	virtual void PlayHitFX(const FVector& ImpactPoint);
 
 	virtual void Jump() override;
 
-	UFUNCTION(Server, WithValidation, Reliable)
-	virtual void Jump_Server();
+	/** Also allows the wall jumps while falling */
+	virtual bool CanJumpInternal_Implementation() const override;
+
+	/**
+	* Finds the launch velocity of a wall jump
+	* @param OutVelocity - The launch velocity
+	* @return False if there is no wall to jump from
+	*/
+	bool GetWallJumpVelocity(FVector& OutVelocity);
 
 	struct DetectWallResult
 	{
@@ -198,6 +236,31 @@ public:
 
 	virtual void Tick(float DeltaTime) override;
 
+	/** Skips the ticks of the characters of lower significance until their tick interval elapsed */
+	virtual void TickActor(float DeltaTime, enum ELevelTick TickType, FActorTickFunction& ThisTickFunction) override;
+
+	/**
+	* Sets the significance of the character for the local players
+	* @param NewSignificance - The new significance
+	* @param TickInterval - The minimum time between two ticks of the character (0 ticks every frame)
+	*/
+	void SetSignificance(ECharacterSignificance::Type NewSignificance, float TickInterval);
+
+	virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+
+	/** Counts the traffic of the RPCs (see FNetStats) */
+	virtual bool CallRemoteFunction(UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack) override;
+
+	/** Uses the relevancy grid (see ANetRelevancyGrid) when it tracks the player */
+	virtual bool IsNetRelevantFor(APlayerController* RealViewer, AActor* Viewer, const FVector& SrcLocation) override;
+
+	/** Scales the priority with the distance to the player when the relevancy grid tracks the player */
+	virtual float GetNetPriority(const FVector& ViewPos, const FVector& ViewDir, APlayerController* Viewer, UActorChannel* InChannel, float Time, bool bLowBandwidth) override;
+
+	/** Applies the replicated state to the character's properties */
+	UFUNCTION()
+	virtual void OnRep_ReplicatedState();
+
 	/** Used for moving forward and backward */
 	virtual void MoveForward(float AxisValue);
 
@@ -210,80 +273,114 @@ public:
 
 	virtual void RightDash();
 
-	virtual void Dash(float Force);
+	/**
+	* Requests a dash. The dash is performed by the movement component (see UPacboyCharacterMovement)
+	* @param bRight - Whether to dash to the right or to the left
+	*/
+	virtual void Dash(bool bRight);
 
-	UFUNCTION(Server, WithValidation, Reliable)
-	virtual void Dash_Server(float Force);
+	/** Returns the launch velocity of a dash in the given direction */
+	FVector GetDashVelocity(bool bRight) const;
 
-	virtual void SprintStart();
+	/** Returns the character movement component (see UPacboyCharacterMovement) */
+	UPacboyCharacterMovement* GetPacboyMovement() const;
 
-	UFUNCTION(Server, WithValidation, Reliable)
-	virtual void SprintStart_Server();
+	virtual void SprintStart();
 
 	virtual void SprintStop();
 
-	UFUNCTION(Server, WithValidation, Reliable)
-	virtual void SprintStop_Server();
-
 	virtual void AimStart();
 
-	UFUNCTION(Server, WithValidation, Reliable)
-	virtual void AimStart_Server();
-
 	virtual void AimStop();
 
-	UFUNCTION(Server, WithValidation, Reliable)
-	virtual void AimStop_Server();
-
 	virtual void FireStart_Key();
 
-	virtual void FireStart(bool FromClient);
-
-	UFUNCTION(Server, WithValidation, Reliable)
-	virtual void FireStart_Server(bool FromClient);
+	virtual void FireStart();
 
 	virtual void FireStop();
 
-	UFUNCTION(Server, WithValidation, Reliable)
-	virtual void FireStop_Server();
+	/** Returns whether the equipped weapon can fire a shot (ignoring the fire input and the rate of fire) */
+	bool CanFire() const;
 
-	virtual void OnFire();
+	/**
+	* Fires the shots of the equipped weapon that are due (see FWeaponFireScheduler).
+	* Called every frame by the player controlling the character (the owning client predicts its shots)
+	*/
+	void UpdateFire();
 
-	/** Spawns projectile */
-	UFUNCTION(Server, WithValidation, Reliable)
-	virtual void OnFire_Server(FVector SpawnLocation, FRotator SpawnRotation, AController* Shooter);
+	/**
+	* Fires a shot of the equipped weapon
+	* @param ShotAge - How long ago the shot was due (the shots due within a frame are fired together)
+	*/
+	virtual void OnFire(float ShotAge);
 
-	UFUNCTION(Client, Reliable)
-	virtual void OnFire_Client();
+	/** Fires the shots predicted by the owning client again on the server (see FFireCommandBatch) */
+	UFUNCTION(Server, WithValidation, Unreliable)
+	virtual void FireCommands_Server(const FFireCommandBatch& Batch);
 
-	UFUNCTION(Client, Reliable)
-	virtual void Reload_Client();
+	/**
+	* Fires a shot of the owning client on the server, once it passed the checks of FireCommands_Server
+	* @param Command - The shot
+	*/
+	virtual void OnFireCommand(const FFireCommand& Command);
+
+	/**
+	* Queues a shot to be sent to the server. The queued shots are sent once per frame
+	* @param Origin - The location the shot was fired from
+	* @param Direction - The direction of the shot
+	* @param ShotAge - How long ago the shot was due (see OnFire)
+	* @param Hit - The hit of the shot if it hit a damageable actor (see MakeHitDescriptor), NULL otherwise
+	*/
+	void QueueFireCommand(const FVector& Origin, const FVector& Direction, float ShotAge, const FHitDescriptor* Hit = NULL);
 
+	/** Sends the shots queued this frame to the server */
+	void FlushFireCommands();
+
+	/** Launches a projectile of the equipped weapon from the projectile pool */
+	virtual void SpawnProjectile(const FVector& SpawnLocation, const FRotator& SpawnRotation, AController* Shooter);
+
+	/** Returns whether the equipped weapon can be reloaded */
+	bool CanReload() const;
+
+	/** Starts reloading the equipped weapon (predicted by the owning client) */
 	virtual void ReloadStart();
 
 	UFUNCTION(Server, WithValidation, Reliable)
 	virtual void ReloadStart_Server();
 
-	virtual void ReloadStop();
-
-	UFUNCTION(Server, WithValidation, Reliable)
-	virtual void ReloadStop_Server();
+	/**
+	* Sent to the owning client when the server rejects its reload
+	* @param AmmoInClip - The ammo in the clip of the equipped weapon on the server
+	* @param RemainingAmmo - The remaining ammo of the equipped weapon on the server
+	*/
+	UFUNCTION(Client, Reliable)
+	virtual void ReloadCorrection_Client(int32 AmmoInClip, int32 RemainingAmmo);
 
-	/** Reloads the clip of the character */
+	/** Reloads the clip of the character (called when the reload animation ends) */
 	UFUNCTION(BlueprintCallable, Category = "Character Action")
 	virtual void Reload();
 
-	UFUNCTION(Server, WithValidation, Reliable)
-	virtual void Reload_Server();
+	/** Stops the reload without reloading the clip */
+	virtual void CancelReload();
 
-	UFUNCTION(Client, Reliable)
-	virtual void Reload_OnClient();
+	/**
+	* Respawns the player of the dead character (server only).
+	* The character is reused if the game mode allows it (see APacboyGameMode::RecycleCharacter),
+	* otherwise the player gets a new character
+	*/
+	virtual void RespawnPlayer();
 
-	UFUNCTION(Client, Reliable)
-	virtual void Respawn_Player_Client();
+	/**
+	* Brings the dead character back to life at a new place (server only)
+	* @param Location - The location of the respawned character
+	* @param Rotation - The rotation of the respawned character
+	* @return false if the character can't be reused
+	*/
+	bool Recycle(const FVector& Location, const FRotator& Rotation);
 
-	UFUNCTION(Server, WithValidation, Reliable)
-	virtual void Respawn_Player_Server();
+	/** Resets the character and its weapons for the respawn, on the server and the clients */
+	UFUNCTION(NetMulticast, Reliable)
+	virtual void Respawn_Multicast(FVector_NetQuantize Location, FRotator Rotation);
 
 	UFUNCTION(NetMulticast, Reliable)
 	virtual void Despawn_Actor();
@@ -295,9 +392,7 @@ public:
 	UFUNCTION(Server, WithValidation, Reliable)
 	virtual void FellOutOfWorld_Server(const class UDamageType* dmgType);
 
-	UFUNCTION(Client, Reliable)
-	virtual void FellOutOfWorld_StopEnergy();
-
+	/** Hides the body of the dead character and its weapons */
 	UFUNCTION(NetMulticast, Reliable)
 	virtual void Destroy_Body();
 
@@ -320,7 +415,18 @@ public:
 	/** Return false if insufficient energy */
 	bool UseEnergy(float EnergyValue);
 
-	void UpdateEnergy();
+	/** Returns the current energy (evaluated from the energy base, rate and timestamp) */
+	UFUNCTION(BlueprintCallable, Category = "Character")
+	float GetEnergy() const;
+
+	/** Sets the current energy */
+	void SetEnergy(float NewEnergy);
+
+	/** Returns the energy change per second for the current state of the character */
+	float ComputeEnergyRate() const;
+
+	/** Updates the energy rate if the state of the character changed it */
+	void UpdateEnergyRate();
 
 	UFUNCTION(BlueprintCallable, Category = "Weapon")
 		FRotator GetAimOffsets() const;
@@ -329,8 +435,122 @@ protected:
 
 	USkeletalMeshComponent* WeaponMesh;
 
+	/** Packs the replicated properties of the character into a replicated state */
+	FCharacterReplicatedState PackReplicatedState() const;
+
+	/** Fills the projectile pool with enough projectiles for the weapon's rate of fire */
+	void PrewarmProjectiles(const AWeapon* Weapon);
+
+	/** Spawns a weapon of the given class and attaches it to the character */
+	AWeapon* SpawnWeapon(TSubclassOf<AWeapon> WeaponClass);
+
+	/** Restores the state of the character and its weapons to the state of a new character */
+	void ResetForRespawn();
+
+	/**
+	* Kills the character, counts the death and the kill and schedules the respawn
+	* @param EventInstigator - The Controller responsible for the killing hit
+	*/
+	void Die(AController* EventInstigator);
+
+	/**
+	* Schedules the removal of the dead body and the respawn of the player, after cancelling the other timers of the character
+	* @param bDestroyBody - Whether the body is removed by a timer (it may already be removed)
+	*/
+	void ScheduleDeathTimers(bool bDestroyBody);
+
+	/**
+	* Schedules a method of the character on the gameplay timers (see AGameplayTimerService), replacing the timer of the handle
+	* @param Handle - The handle of the timer
+	* @param Method - The method called when the timer fires
+	* @param Delay - The time until the timer fires
+	*/
+	void SetGameplayTimer(FGameplayTimerHandle& Handle, FGameplayTimerDelegate::TUObjectMethodDelegate<ACharacterBase>::FMethodPtr Method, float Delay);
+
+	/** Cancels the gameplay timer of the handle */
+	void ClearGameplayTimer(FGameplayTimerHandle& Handle);
+
 private:
 
+	/** The last replicated state received from the server */
+	FCharacterReplicatedState LastReceivedState;
+
+	/** Indicates if a replicated state was received from the server */
+	bool bHasReceivedState;
+
+	/** The energy at EnergyTimestamp */
+	float EnergyBase;
+
+	/** The energy change per second since EnergyTimestamp */
+	float EnergyRate;
+
+	/** The time of the last change of the energy base or rate */
+	float EnergyTimestamp;
+
+	/** Incremented whenever the energy is set (lets the clients notice every jump of the energy, see SetEnergy) */
+	uint8 EnergyEpoch;
+
+	/** Stops the sprint once the energy runs out */
+	FGameplayTimerHandle EnergyDepletionTimer;
+
+	/** Completes the reload at the end of the reload animation */
+	FGameplayTimerHandle ReloadTimer;
+
+	/** The minimum time between two ticks of the character, set from its significance */
+	float SignificanceTickInterval;
+
+	/** The time since the last tick of the character, when ticks are skipped */
+	float SkippedTickTime;
+
+	/** The update flag of the mesh for the characters of high and medium significance */
+	TEnumAsByte<EMeshComponentUpdateFlag::Type> DefaultMeshUpdateFlag;
+
+	/** Resets the energy base and rate at the current time */
+	void ResetEnergy(float NewEnergyBase, float NewEnergyRate);
+
+	/** Schedules OnEnergyDepleted for when the sprint runs out of energy */
+	void ScheduleEnergyDepletion();
+
+	/** Stops the sprint once the energy runs out */
+	void OnEnergyDepleted();
+
+	/**
+	* Plays the reload animation and schedules Reload for when it ends.
+	* The server and the clients run it when the reload starts on their side, so the reload
+	* completes from the local start time and nothing is replicated while it is in progress
+	*/
+	void BeginReload();
+
+	/** The sequence number of the next shot fired by this client */
+	uint16 NextFireSequence;
+
+	/** The shots queued this frame */
+	TArray<FFireCommand> PendingFireCommands;
+
+	/** The shots sent with the previous batch (sent again with the next one) */
+	TArray<FFireCommand> LastSentFireCommands;
+
+	/** The sequence number of the first shot in LastSentFireCommands */
+	uint16 LastSentFireSequence;
+
+	/** The sequence number of the last shot processed by the server */
+	uint16 LastProcessedFireSequence;
+
+	/** The client time of the last shot accepted by the server */
+	float LastProcessedFireTime;
+
+	/** The server time minus the client time of the first shot received, to bound the client times of the next ones */
+	float ClientClockOffset;
+
+	/** The shots the server still accepts from this client, refilled at the fire rate of the weapon */
+	float FireTokens;
+
+	/** The server time at which FireTokens was last refilled */
+	float FireTokensTime;
+
+	/** Indicates if the server received a shot from this client */
+	bool bHasProcessedFireCommand;
+
 	GENERATED_BODY()
 
 };
\ No newline at end of file
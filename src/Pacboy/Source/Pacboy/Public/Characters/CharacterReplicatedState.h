@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CharacterReplicatedState.generated.h"
+
+/** The bits of the character state flags */
+namespace ECharacterStateFlags
+{
+	enum Type
+	{
+		Sprinting = 1 << 0,
+		Aiming = 1 << 1,
+		Firing = 1 << 2,
+		Reloading = 1 << 3,
+		Dead = 1 << 4,
+	};
+
+	/** The number of bits sent for the flags */
+	const uint32 NumBits = 5;
+}
+
+/**
+* The replicated state of a character, packed into a single property.
+* The flags are sent as a bitfield and the floats are quantized to 16 bits.
+*/
+USTRUCT()
+struct PACBOY_API FCharacterReplicatedState
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** The state flags (see ECharacterStateFlags) */
+	uint16 Flags;
+
+	/** Health in fixed point (see QuantizeScale) */
+	uint16 Health;
+
+	/** Energy at the last change of the energy rate or value, in fixed point (see QuantizeScale) */
+	uint16 EnergyBase;
+
+	/** Energy change per second in fixed point (see QuantizeScale) */
+	int16 EnergyRate;
+
+	/** Incremented by the server whenever the energy is set (not when only the rate changes) */
+	uint8 EnergyEpoch;
+
+	/** Aim offset pitch (compressed rotator axis) */
+	uint16 CharPitch;
+
+	/** The fixed point scale of Health and Energy (1/32 precision, up to 2047) */
+	static const float QuantizeScale;
+
+	FCharacterReplicatedState();
+
+	bool HasFlag(ECharacterStateFlags::Type Flag) const;
+
+	void SetFlag(ECharacterStateFlags::Type Flag, bool bValue);
+
+	static uint16 QuantizeValue(float Value);
+
+	static float DequantizeValue(uint16 Value);
+
+	static int16 QuantizeRate(float Rate);
+
+	static float DequantizeRate(int16 Rate);
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
+	bool operator==(const FCharacterReplicatedState& Other) const;
+};
+
+template<>
+struct TStructOpsTypeTraits<FCharacterReplicatedState> : public TStructOpsTypeTraitsBase
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true,
+	};
+};
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "Characters/CharacterBase.h"
+#include "AimCameraComponent.h"
 #include "MainCharacter.generated.h"
 
 /**
@@ -25,6 +26,10 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Camera")
 	UCameraComponent* FollowCamera;
 
+	/** Moves the camera booms when the character starts or stops aiming */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Camera")
+	UAimCameraComponent* AimCamera;
+
 	/** The length of the camera boom while the character is aiming */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera")
 	float CameraBoomLengthWhileAiming;
@@ -49,9 +54,13 @@ public:
 
 	virtual void BeginPlay() override;
 
-	virtual void Tick(float DeltaTime) override;
+	virtual void AimStart() override;
+
+	virtual void AimStop() override;
+
+	virtual void OnRep_ReplicatedState() override;
 
-	virtual void OnFire() override;
+	virtual void OnFire(float ShotAge) override;
 
 	/** Toggles camera position (left/right) while aiming */
 	virtual void ToggleCameraPosition();
@@ -80,11 +89,11 @@ private:
 	/** The starting length of the camera boom extension */
 	float CameraBoomExtensionLengthCache;
 
-	/** Move the camera closer to the character */
-	void MoveCameraCloserToCharacter(float TransitionSmoothSpeed, float DeltaTime);
+	/** Indicates if the camera booms were last moved to the aiming lengths */
+	bool bAimCameraAiming;
 
-	/** Move the camera away from the character */
-	void MoveCameraFurtherFromCharacter(float TransitionSmoothSpeed, float DeltaTime);
+	/** Moves the camera booms to the lengths of the current aiming state, if it changed */
+	void UpdateAimCamera();
 
 	GENERATED_BODY()
 
@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/CharacterMovementComponent.h"
+#include "PacboyCharacterMovement.generated.h"
+
+/**
+* Character movement that carries the sprint, aim and fire input states inside the saved moves,
+* so the speed changes are predicted and replayed by the client instead of being set by reliable RPCs.
+* The dash and the wall jump are performed here too, so the client and the server run them once per move.
+* The input states are sent as the custom flags of the compressed move flags:
+* FLAG_Custom_0 - Sprint, FLAG_Custom_1 - Aim, FLAG_Custom_2 - Fire, FLAG_Custom_3 - Dash,
+* FLAG_Reserved_1 - Dash to the right, FLAG_Reserved_2 - Reloading (both unused by the engine)
+*/
+UCLASS()
+class PACBOY_API UPacboyCharacterMovement : public UCharacterMovementComponent
+{
+public:
+
+	/** Indicates if the player wants to sprint */
+	uint32 bWantsToSprint : 1;
+
+	/** Indicates if the player wants to aim */
+	uint32 bWantsToAim : 1;
+
+	/** Indicates if the player wants to fire */
+	uint32 bWantsToFire : 1;
+
+	/** Indicates if the player wants to dash (cleared once the dash is performed) */
+	uint32 bWantsToDash : 1;
+
+	/** Indicates if the requested dash is to the right */
+	uint32 bDashRight : 1;
+
+	/** Indicates if the character is reloading (it can't sprint then). Set by ACharacterBase and saved with the moves */
+	uint32 bIsReloading : 1;
+
+	/** Snaps the simulated character to the corrected locations instead of smoothing the corrections (see ASignificanceManager) */
+	uint32 bSkipNetworkSmoothing : 1;
+
+	/** How long a wall touched while moving is remembered for the wall jumps */
+	UPROPERTY(EditAnywhere, Category = "Character Movement")
+	float WallContactMaxAge;
+
+	/** The maximum distance between the character and a remembered wall */
+	UPROPERTY(EditAnywhere, Category = "Character Movement")
+	float WallContactDistance;
+
+	UPacboyCharacterMovement(const FObjectInitializer& ObjectInitializer);
+
+	virtual float GetMaxSpeed() const override;
+
+	virtual void UpdateFromCompressedFlags(uint8 Flags) override;
+
+	/** Performs the ground jump, or the wall jump while falling */
+	virtual bool DoJump(bool bReplayingMoves) override;
+
+	/**
+	* Finds the wall the character touched recently while moving
+	* @param OutNormal - The normal of the wall
+	* @return False if no wall was touched recently or if the character moved away from it
+	*/
+	bool FindWallContact(FVector& OutNormal) const;
+
+	/** Remembers the walls the character runs into */
+	virtual void HandleImpact(FHitResult const& Hit, float TimeSlice = 0.f, const FVector& MoveDelta = FVector::ZeroVector) override;
+
+	virtual class FNetworkPredictionData_Client* GetPredictionData_Client() const override;
+
+	virtual void SmoothCorrection(const FVector& OldLocation) override;
+
+	/** Replays the moves after a correction, then restores the current reload state (the moves replay their own) */
+	virtual void ClientUpdatePositionAfterServerUpdate() override;
+
+	virtual void ClientAdjustPosition_Implementation(float TimeStamp, FVector NewLoc, FVector NewVel, UPrimitiveComponent* NewBase, FName NewBaseBoneName, bool bHasBase, bool bBaseRelativePosition, uint8 ServerMovementMode) override;
+
+protected:
+
+	virtual void PerformMovement(float DeltaTime) override;
+
+	/** Launches the character to the requested side */
+	void PerformDash();
+
+private:
+
+	/** The impact point of the last wall touched */
+	FVector WallContactPoint;
+
+	/** The normal of the last wall touched */
+	FVector WallContactNormal;
+
+	/** The time the last wall was touched */
+	float WallContactTime;
+
+	GENERATED_BODY()
+
+};
@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "CosmeticEvents.generated.h"
+
+class ACharacterBase;
+
+UENUM()
+namespace ECosmeticEventType
+{
+	enum Type
+	{
+		/** A weapon was fired (muzzle flash and shot sound) */
+		Muzzle,
+		/** An instant shot hit something */
+		Impact,
+		/** A character was hit */
+		Hit
+	};
+}
+
+/**
+* A purely cosmetic event. Events can be culled or lost, so they must never change gameplay state
+*/
+USTRUCT()
+struct FCosmeticEvent
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** The type of the event */
+	UPROPERTY()
+	TEnumAsByte<ECosmeticEventType::Type> Type;
+
+	/** The character that fired (muzzle, impact) or was hit (hit) */
+	UPROPERTY()
+	ACharacterBase* Character;
+
+	/** The location of the event */
+	UPROPERTY()
+	FVector_NetQuantize Location;
+
+	FCosmeticEvent()
+		: Type(ECosmeticEventType::Muzzle)
+		, Character(NULL)
+		, Location(FVector::ZeroVector)
+	{
+	}
+};
+
+/**
+* Collects the cosmetic events of a server frame and sends them at the end of the frame,
+* as one unreliable bundle per connection. Each connection only gets the events close enough
+* to its viewer and caused by characters that are relevant to it.
+*/
+UCLASS(NotPlaceable, Transient)
+class PACBOY_API ACosmeticEventRelay : public AActor
+{
+public:
+
+	/** Events further away from a viewer than this are not sent to it */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Effects")
+	float MaxEventDistance;
+
+	/** The maximum number of events sent to a connection per frame */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Effects")
+	int32 MaxEventsPerBundle;
+
+	ACosmeticEventRelay(const FObjectInitializer& ObjectInitializer);
+
+	/** Returns the cosmetic event relay of the world (spawns it on first use). Returns NULL on clients */
+	static ACosmeticEventRelay* Get(UWorld* World);
+
+	/**
+	* Queues an event to be sent at the end of the frame
+	* @param Type - The type of the event
+	* @param Character - The character that fired or was hit
+	* @param Location - The location of the event
+	*/
+	void QueueEvent(ECosmeticEventType::Type Type, ACharacterBase* Character, const FVector& Location);
+
+	/** Plays the event on this machine */
+	static void PlayEvent(const FCosmeticEvent& Event);
+
+	virtual void Tick(float DeltaTime) override;
+
+private:
+
+	/** The events queued this frame */
+	UPROPERTY()
+	TArray<FCosmeticEvent> QueuedEvents;
+
+	/** Checks if the event should be sent to (or played for) the player */
+	bool IsEventRelevantFor(const FCosmeticEvent& Event, APlayerController* PlayerController, const FVector& ViewLocation) const;
+
+	GENERATED_BODY()
+
+};
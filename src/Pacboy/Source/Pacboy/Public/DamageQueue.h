@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "DamageableObject.h"
+#include "GameFramework/Actor.h"
+#include "DamageQueue.generated.h"
+
+/**
+* Collects the hits taken on the server during a frame and applies them once per target, after the physics
+* (the projectiles hit during their movement, the hitscan shots are fired and confirmed before it).
+* The targets are processed in the order of their first hit of the frame, and the hits of a target in the order
+* they were taken, so the deaths and the kills are resolved once, in a deterministic order, whatever caused the hits
+*/
+UCLASS(NotPlaceable, Transient)
+class PACBOY_API ADamageQueue : public AActor
+{
+public:
+
+	ADamageQueue(const FObjectInitializer& ObjectInitializer);
+
+	/** Returns the damage queue of the world (spawns it on first use). Returns NULL on clients */
+	static ADamageQueue* Get(UWorld* World);
+
+	/**
+	* Queues a hit to be applied at the end of the physics
+	* @param Target - The object that takes the damage
+	* @param Damage - How much damage to apply
+	* @param Hit - Hit information
+	* @param EventInstigator - The Controller responsible for the damage
+	*/
+	void QueueDamage(UObject* Target, float Damage, const FHitResult& Hit, AController* EventInstigator);
+
+	/** Applies all the queued hits */
+	void Flush();
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+
+	/** The hits of a target */
+	struct FDamageTarget
+	{
+		TWeakObjectPtr<UObject> Target;
+
+		TArray<FQueuedHit> Hits;
+	};
+
+	/** The targets hit this frame, in the order of their first hit */
+	TArray<FDamageTarget> Targets;
+
+	/** The index of every target in Targets */
+	TMap<const UObject*, int32> TargetIndices;
+
+	GENERATED_BODY()
+
+};
@@ -4,6 +4,28 @@
 
 #include "DamageableObject.generated.h"
 
+/**
+* A hit waiting in the damage queue (see ADamageQueue)
+*/
+struct FQueuedHit
+{
+	/** How much damage to apply */
+	float Damage;
+
+	/** Hit information */
+	FHitResult Hit;
+
+	/** The Controller responsible for the damage */
+	TWeakObjectPtr<AController> EventInstigator;
+
+	FQueuedHit(float InDamage, const FHitResult& InHit, AController* InEventInstigator)
+		: Damage(InDamage)
+		, Hit(InHit)
+		, EventInstigator(InEventInstigator)
+	{
+	}
+};
+
 /**
 *
 */
@@ -28,6 +50,12 @@ public:
 	*/
 	virtual void TakeDamage(float Damage, const FHitResult& Hit, AController* EventInstigator) = 0;
 
+	/**
+	* Applies the hits the IDamageableObject took this frame, at once (called by the damage queue on the server)
+	* @param Hits - The hits, in the order they were taken
+	*/
+	virtual void ApplyQueuedDamage(const TArray<FQueuedHit>& Hits) = 0;
+
 private:
 
 	GENERATED_IINTERFACE_BODY()
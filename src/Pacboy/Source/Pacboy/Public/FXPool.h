@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "FXPool.generated.h"
+
+/**
+* The pooled particle system components of one particle system
+*/
+USTRUCT()
+struct FFXPoolBucket
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** The particle system of this bucket */
+	UPROPERTY()
+	UParticleSystem* Template;
+
+	/** Finished components, ready to be played again */
+	UPROPERTY()
+	TArray<UParticleSystemComponent*> FreeComponents;
+
+	/** The components currently playing, the oldest first */
+	UPROPERTY()
+	TArray<UParticleSystemComponent*> ActiveComponents;
+
+	FFXPoolBucket()
+		: Template(NULL)
+	{
+	}
+};
+
+/**
+* Per-world pool of particle system components for the short one-shot effects (muzzle flashes, impacts, hits).
+* Components are created once per particle system and played again once they finish, instead of
+* creating a new component for every effect. When too many effects of the same particle system are
+* playing, the oldest one is stopped and reused.
+*/
+UCLASS(NotPlaceable, Transient)
+class PACBOY_API AFXPool : public AActor
+{
+public:
+
+	/** The maximum number of components per particle system. When reached, the oldest playing effect is reused */
+	UPROPERTY(EditAnywhere, Category = "FX")
+	int32 MaxComponentsPerTemplate;
+
+	AFXPool(const FObjectInitializer& ObjectInitializer);
+
+	/** Returns the FX pool of the world (spawns it on first use). Returns NULL if the world doesn't play cosmetic effects */
+	static AFXPool* Get(UWorld* World);
+
+	/**
+	* Plays a particle system at the given location
+	* @param Template - The particle system to play
+	* @param Location - The world location of the effect
+	* @param Rotation - The world rotation of the effect
+	*/
+	UParticleSystemComponent* SpawnAtLocation(UParticleSystem* Template, const FVector& Location, const FRotator& Rotation = FRotator::ZeroRotator);
+
+	/**
+	* Plays a particle system attached to a component
+	* @param Template - The particle system to play
+	* @param AttachToComponent - The component to attach the effect to
+	* @param AttachPointName - The socket or bone to attach the effect to
+	*/
+	UParticleSystemComponent* SpawnAttached(UParticleSystem* Template, USceneComponent* AttachToComponent, FName AttachPointName = NAME_None);
+
+private:
+
+	/** The pooled components, one bucket per particle system */
+	UPROPERTY()
+	TArray<FFXPoolBucket> Buckets;
+
+	/** The number of components currently playing (all particle systems) */
+	int32 ActiveCount;
+
+	/** The number of finished components waiting in the pool (all particle systems) */
+	int32 FreeCount;
+
+	FFXPoolBucket& FindOrAddBucket(UParticleSystem* Template);
+
+	/** Takes a finished component from the bucket, steals the oldest playing one or creates a new one */
+	UParticleSystemComponent* AcquireComponent(FFXPoolBucket& Bucket);
+
+	/** Puts the components back in the pool once their particles are gone */
+	UFUNCTION()
+	void OnComponentFinished(UParticleSystemComponent* Component);
+
+	void UpdateStats();
+
+	GENERATED_BODY()
+
+};
@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "HitDescriptor.h"
+#include "FireCommand.generated.h"
+
+/**
+* A single shot fired by a client
+*/
+USTRUCT()
+struct PACBOY_API FFireCommand
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** The location the shot was fired from */
+	FVector_NetQuantize10 Origin;
+
+	/** The direction of the shot */
+	FVector_NetQuantizeNormal Direction;
+
+	/** The client time at which the shot was fired */
+	float ClientTime;
+
+	/** Indicates if the shot hit a damageable actor on the client (instant weapons only) */
+	bool bHasHit;
+
+	/** The hit of the shot, checked by the server before applying the damage (if bHasHit) */
+	FHitDescriptor Hit;
+
+	FFireCommand()
+		: Origin(FVector::ZeroVector)
+		, Direction(FVector::ZeroVector)
+		, ClientTime(0.f)
+		, bHasHit(false)
+	{
+	}
+};
+
+/**
+* All shots fired by a client in one frame (plus the shots of the previous batch, in case it was lost).
+* The shots have consecutive sequence numbers, starting with FirstSequence.
+*/
+USTRUCT()
+struct PACBOY_API FFireCommandBatch
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** The maximum number of shots in one batch */
+	static const int32 MaxCommands = 32;
+
+	/** The sequence number of the first shot */
+	uint16 FirstSequence;
+
+	/** The shots */
+	TArray<FFireCommand> Commands;
+
+	FFireCommandBatch()
+		: FirstSequence(0)
+	{
+	}
+
+	/** Returns true if sequence number A was issued after B (handles wrap-around) */
+	static bool IsSequenceNewer(uint16 A, uint16 B)
+	{
+		return (int16)(A - B) > 0;
+	}
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FFireCommandBatch> : public TStructOpsTypeTraitsBase
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
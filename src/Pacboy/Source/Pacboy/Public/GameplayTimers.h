@@ -0,0 +1,224 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "GameplayTimers.generated.h"
+
+DECLARE_DELEGATE(FGameplayTimerDelegate);
+
+/**
+* Identifies a timer of FGameplayTimerWheel. A handle stays invalid once its timer fired or was cancelled,
+* even if the timer's slot is reused by a new timer
+*/
+struct FGameplayTimerHandle
+{
+	FGameplayTimerHandle()
+		: Index(INDEX_NONE)
+		, Serial(0)
+	{
+	}
+
+	bool IsValid() const
+	{
+		return this->Index != INDEX_NONE;
+	}
+
+	void Invalidate()
+	{
+		this->Index = INDEX_NONE;
+		this->Serial = 0;
+	}
+
+	bool operator==(const FGameplayTimerHandle& Other) const
+	{
+		return (this->Index == Other.Index) && (this->Serial == Other.Serial);
+	}
+
+private:
+
+	/** The index of the timer in the wheel */
+	int32 Index;
+
+	/** Incremented every time the timer's slot is reused */
+	uint32 Serial;
+
+	friend class FGameplayTimerWheel;
+};
+
+/**
+* Hierarchical timing wheel of one-shot timers. Time is counted in ticks of TickResolution seconds,
+* and the timers are kept in linked lists, one per wheel slot: the first level has a slot per tick,
+* and every next level has a slot per full turn of the previous level. The timers of a slot of the
+* higher levels are moved down a level when the previous level completes a turn.
+* Scheduling and cancelling a timer are O(1), and advancing the wheel only visits the slots of the elapsed ticks.
+* The timers of an owner are linked together too, so all of them can be cancelled at once (e.g. on death or EndPlay).
+*/
+class PACBOY_API FGameplayTimerWheel
+{
+public:
+
+	/** The number of slots of a level (a power of two) */
+	static const int32 SlotBits = 6;
+
+	static const int32 NumSlots = 1 << SlotBits;
+
+	/** The number of levels. The wheel covers NumSlots^NumLevels ticks, longer timers are checked again when their slot comes up */
+	static const int32 NumLevels = 4;
+
+	/**
+	* @param InTickResolution - The length of a tick in seconds. The timers fire on the first tick at or after their time
+	*/
+	explicit FGameplayTimerWheel(float InTickResolution = 1.f / 120.f);
+
+	/**
+	* Schedules a timer
+	* @param Owner - The object the timer belongs to (see CancelAll)
+	* @param Delay - The time until the timer fires (at least one tick)
+	* @param Delegate - Executed when the timer fires
+	*/
+	FGameplayTimerHandle Schedule(const UObject* Owner, float Delay, const FGameplayTimerDelegate& Delegate);
+
+	/** Cancels the timer (if it didn't fire yet) and invalidates the handle */
+	void Cancel(FGameplayTimerHandle& Handle);
+
+	/** Cancels all the timers of the owner */
+	void CancelAll(const UObject* Owner);
+
+	/** Returns whether the timer is still waiting to fire */
+	bool IsActive(const FGameplayTimerHandle& Handle) const;
+
+	/** Returns the time until the timer fires (-1 if it is not active) */
+	float GetTimeRemaining(const FGameplayTimerHandle& Handle) const;
+
+	/** Returns the number of timers waiting to fire */
+	int32 GetNumTimers() const
+	{
+		return this->NumTimers;
+	}
+
+	/**
+	* Moves the wheel forward and fires the timers that are due
+	* @param DeltaTime - The elapsed time
+	* @return The number of timers that fired
+	*/
+	int32 Advance(float DeltaTime);
+
+private:
+
+	/** A scheduled timer, or a free entry of the timer array */
+	struct FTimer
+	{
+		FGameplayTimerDelegate Delegate;
+
+		const UObject* Owner;
+
+		/** The tick the timer fires at */
+		uint64 ExpireTick;
+
+		uint32 Serial;
+
+		/** The list that holds the timer: a slot, PendingList, or INDEX_NONE if the entry is free */
+		int32 List;
+
+		/** The neighbours in the list of the timer (the next free entry for the free entries) */
+		int32 Prev;
+
+		int32 Next;
+
+		/** The neighbours in the list of the owner's timers */
+		int32 OwnerPrev;
+
+		int32 OwnerNext;
+	};
+
+	/** The list of the timers being fired (moved out of their slot, so the fired delegates can cancel them) */
+	static const int32 PendingList = NumLevels * NumSlots;
+
+	float TickResolution;
+
+	/** The time since the last tick */
+	float TimeSinceTick;
+
+	/** The last tick processed */
+	uint64 CurrentTick;
+
+	/** All the timers, the free entries are reused */
+	TArray<FTimer> Timers;
+
+	/** The first free entry of Timers */
+	int32 FirstFree;
+
+	/** The first timer of every slot and of the pending list */
+	int32 ListHeads[NumLevels * NumSlots + 1];
+
+	/** The first timer of every owner */
+	TMap<const UObject*, int32> OwnerHeads;
+
+	int32 NumTimers;
+
+	/** Puts the timer in the slot of its expire tick */
+	void Insert(int32 Index);
+
+	void LinkToList(int32 Index, int32 List);
+
+	void UnlinkFromList(int32 Index);
+
+	void LinkToOwner(int32 Index);
+
+	void UnlinkFromOwner(int32 Index);
+
+	/** Unlinks the timer and frees its entry */
+	void Release(int32 Index);
+
+	/** Returns the index of the timer of the handle, or INDEX_NONE if the timer is not active */
+	int32 Find(const FGameplayTimerHandle& Handle) const;
+
+	/** Processes the next tick */
+	int32 Step();
+};
+
+/**
+* Per-world service of the gameplay timers (see FGameplayTimerWheel). Used instead of the timer manager
+* for the timers of the characters and projectiles. Pauses with the game like the timer manager.
+*/
+UCLASS(NotPlaceable, Transient)
+class PACBOY_API AGameplayTimerService : public AActor
+{
+public:
+
+	AGameplayTimerService(const FObjectInitializer& ObjectInitializer);
+
+	/** Returns the timer service of the world (spawns it on first use) */
+	static AGameplayTimerService* Get(UWorld* World);
+
+	/**
+	* Schedules a timer that calls a method of the owner
+	* @param Owner - The object that owns the timer and whose method is called
+	* @param Method - The method to call
+	* @param Delay - The time until the timer fires
+	*/
+	template<class UserClass>
+	FGameplayTimerHandle SetTimer(UserClass* Owner, typename FGameplayTimerDelegate::TUObjectMethodDelegate<UserClass>::FMethodPtr Method, float Delay)
+	{
+		return this->Wheel.Schedule(Owner, Delay, FGameplayTimerDelegate::CreateUObject(Owner, Method));
+	}
+
+	/** Cancels the timer (if it didn't fire yet) and invalidates the handle */
+	void ClearTimer(FGameplayTimerHandle& Handle);
+
+	/** Cancels all the timers of the owner */
+	void ClearAllTimers(const UObject* Owner);
+
+	/** Returns whether the timer is still waiting to fire */
+	bool IsTimerActive(const FGameplayTimerHandle& Handle) const;
+
+	virtual void Tick(float DeltaTime) override;
+
+private:
+
+	FGameplayTimerWheel Wheel;
+
+	GENERATED_BODY()
+
+};
@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "HitDescriptor.generated.h"
+
+namespace EHitZone
+{
+	enum Type
+	{
+		Body,
+		Head,
+
+		NumZones
+	};
+}
+
+/**
+* A hit reported by a client with the fire command of its shot, sent instead of a full FHitResult.
+* Serialized, a FHitResult is about 70 bytes (4 quantized vectors, 2 normals, 4 floats and ints,
+* 3 object references and a bone name), while the descriptor is about 11 bytes for typical
+* map coordinates: the target reference (2-4 bytes), the impact point rounded to a unit (6-8 bytes)
+* and the hit zone (2 bits). The shot sequence number is the one of the fire command (not serialized)
+*/
+USTRUCT()
+struct PACBOY_API FHitDescriptor
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** The actor that was hit */
+	UPROPERTY()
+	AActor* Target;
+
+	/** The impact point of the hit */
+	FVector_NetQuantize ImpactPoint;
+
+	/** The zone of the target that was hit (see EHitZone) */
+	uint8 HitZone;
+
+	/** The sequence number of the shot (see FFireCommandBatch) */
+	uint16 ShotSequence;
+
+	FHitDescriptor()
+		: Target(NULL)
+		, ImpactPoint(FVector::ZeroVector)
+		, HitZone(EHitZone::Body)
+		, ShotSequence(0)
+	{
+	}
+
+	FHitDescriptor(const FHitResult& Hit, EHitZone::Type InHitZone, uint16 InShotSequence);
+
+	/**
+	* Expands the descriptor to the engine hit type (done by the server)
+	* @param TraceStart - The location the shot is considered to start from
+	* @return A blocking hit of the target at the impact point. The trace ends a bit past the impact point
+	*/
+	FHitResult ToHitResult(const FVector& TraceStart) const;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FHitDescriptor> : public TStructOpsTypeTraitsBase
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Components/ActorComponent.h"
+#include "LagCompensationComponent.generated.h"
+
+/**
+* The pose of a character at a moment in time
+*/
+USTRUCT()
+struct FCharacterPoseSnapshot
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** The server time of the snapshot */
+	float Time;
+
+	/** The location of the capsule */
+	FVector CapsuleLocation;
+
+	/** The rotation of the capsule */
+	FQuat CapsuleRotation;
+
+	/** The location of the head hitbox */
+	FVector HeadLocation;
+
+	FCharacterPoseSnapshot()
+		: Time(0.f)
+		, CapsuleLocation(FVector::ZeroVector)
+		, CapsuleRotation(FQuat::Identity)
+		, HeadLocation(FVector::ZeroVector)
+	{
+	}
+};
+
+/**
+* Records the recent poses of a character on the server, so that hitscan shots
+* reported by clients can be checked against the pose the shooter actually saw.
+* The history is a fixed-size ring buffer that is allocated once.
+*/
+UCLASS()
+class PACBOY_API ULagCompensationComponent : public UActorComponent
+{
+public:
+
+	/** How many seconds of poses are kept. Shots older than this are checked against the oldest pose */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Lag Compensation")
+	float HistoryDuration;
+
+	/** How many poses are recorded per second */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Lag Compensation")
+	float SnapshotRate;
+
+	/** The bone used for the head hitbox */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Lag Compensation")
+	FName HeadBoneName;
+
+	/** The radius of the head hitbox */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Lag Compensation")
+	float HeadRadius;
+
+	/** How far (in units) a shot may miss the rewound hitboxes and still count as a hit */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Lag Compensation")
+	float HitTolerance;
+
+	ULagCompensationComponent(const FObjectInitializer& ObjectInitializer);
+
+	virtual void TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction *ThisTickFunction) override;
+
+	virtual void OnComponentDestroyed() override;
+
+	/**
+	* Finds the pose of the character at the given time (interpolated between the recorded poses)
+	* @param Time - The server time
+	* @param OutPose - The pose at the given time
+	* @return false if no pose was recorded yet
+	*/
+	bool GetPoseAtTime(float Time, FCharacterPoseSnapshot& OutPose) const;
+
+	/**
+	* Checks if a shot hits the character as it was posed at the given time
+	* @param Time - The server time the shooter saw the character at
+	* @param TraceStart - The start of the shot
+	* @param TraceEnd - The end of the shot
+	*/
+	bool DoesShotHitAtTime(float Time, const FVector& TraceStart, const FVector& TraceEnd) const;
+
+	/** Forgets the recorded poses (the character was moved to a new place, e.g. on respawn) */
+	void ClearHistory();
+
+private:
+
+	/** The recorded poses (ring buffer) */
+	TArray<FCharacterPoseSnapshot> Snapshots;
+
+	/** The index of the oldest recorded pose */
+	int32 OldestIndex;
+
+	/** The number of recorded poses */
+	int32 NumSnapshots;
+
+	/** The time left until the next pose is recorded */
+	float TimeUntilNextSnapshot;
+
+	/** Allocates the ring buffer */
+	void AllocateHistory();
+
+	/** Records the current pose of the owner */
+	void RecordSnapshot();
+
+	/** Returns the pose at the given position in the history (0 is the oldest pose) */
+	const FCharacterPoseSnapshot& GetSnapshot(int32 Index) const;
+
+	GENERATED_BODY()
+
+};
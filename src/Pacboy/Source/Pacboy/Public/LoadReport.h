@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "LoadReport.generated.h"
+
+/** The load measured by APacboyLoadReport over a period */
+struct FLoadSample
+{
+	/** The number of frames */
+	int32 Frames;
+
+	/** The game thread time of all frames (milliseconds) */
+	double GameThreadTime;
+
+	/** The highest game thread time of a frame (milliseconds) */
+	float MaxGameThreadTime;
+
+	/** The bytes sent and received by the server */
+	int64 OutBytes;
+
+	int64 InBytes;
+
+	/** The RPCs sent by the server (only counted when the net stats are compiled in) */
+	int64 RPCs;
+
+	/** The characters and weapons spawned and destroyed (see APacboyLoadReport::RecordActorSpawned) */
+	int64 ActorSpawns;
+
+	int64 ActorDestroys;
+
+	/** The highest physical memory used by the process (bytes) */
+	uint64 MaxUsedMemory;
+
+	/** The duration of the period (seconds) */
+	float Duration;
+
+	FLoadSample()
+		: Frames(0)
+		, GameThreadTime(0.0)
+		, MaxGameThreadTime(0.f)
+		, OutBytes(0)
+		, InBytes(0)
+		, RPCs(0)
+		, ActorSpawns(0)
+		, ActorDestroys(0)
+		, MaxUsedMemory(0)
+		, Duration(0.f)
+	{
+	}
+
+	void Add(const FLoadSample& Other);
+};
+
+/**
+* Logs the load of a dedicated server during load tests (see APacboyBotDriver and Scripts/LoadTest.sh):
+* the frame rate, the game thread time, the bandwidth, the RPC rate, the actor churn and the memory, every interval and for the whole run.
+* Started by running the server with -PacboyLoadReport=<Seconds>
+*/
+UCLASS(NotPlaceable, Transient)
+class PACBOY_API APacboyLoadReport : public AActor
+{
+public:
+
+	APacboyLoadReport(const FObjectInitializer& ObjectInitializer);
+
+	/**
+	* Returns whether the command line asks for the load report
+	* @param OutInterval - The time between two reports
+	*/
+	static bool IsEnabled(float& OutInterval);
+
+	/** Returns the load report of the world (spawns it on first use). Returns NULL if the world is not a server */
+	static APacboyLoadReport* Get(UWorld* World);
+
+	/** Counts a spawned character or weapon (the actors spawned per life of a player) */
+	static void RecordActorSpawned();
+
+	/** Counts a destroyed character or weapon */
+	static void RecordActorDestroyed();
+
+	virtual void BeginPlay() override;
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+
+	/** The time between two reports */
+	float ReportInterval;
+
+	/** The load since the last report */
+	FLoadSample Current;
+
+	/** The load since the beginning of the run */
+	FLoadSample Total;
+
+	/** The last values of the net driver counters (they are reset by the net driver every second) */
+	int32 LastOutBytes;
+
+	int32 LastInBytes;
+
+	/** The RPC count of the net stats at the last tick */
+	int64 LastRPCs;
+
+	/** The actor counts at the last tick */
+	int64 LastActorSpawns;
+
+	int64 LastActorDestroys;
+
+	/** The actors spawned and destroyed since the start of the process */
+	static int64 TotalActorSpawns;
+
+	static int64 TotalActorDestroys;
+
+	/** Logs a sample */
+	void Report(const TCHAR* Label, const FLoadSample& Sample) const;
+
+	GENERATED_BODY()
+
+};
@@ -4,6 +4,7 @@
 
 #include <string>
 #include "GameFramework/PlayerController.h"
+#include "CosmeticEvents.h"
 #include "MainPlayerController.generated.h"
 
 /**
@@ -22,6 +23,16 @@ public:
 
 	AMainPlayerController(const FObjectInitializer& ObjectInitializer);
 
+	/** Starts the bot of the load tests (see APacboyBotDriver) */
+	virtual void BeginPlay() override;
+
+	/** Counts the traffic of the RPCs (see FNetStats) */
+	virtual bool CallRemoteFunction(UFunction* Function, void* Parameters, FOutParmRec* OutParms, FFrame* Stack) override;
+
+	/** Plays the cosmetic events sent by the server this frame */
+	UFUNCTION(Client, Unreliable)
+	void PlayCosmeticEvents_Client(const TArray<FCosmeticEvent>& Events);
+
 private:
 
 	GENERATED_BODY()
@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "NetRelevancyGrid.generated.h"
+
+/**
+* Uniform spatial hash of the replicated actors, used by the server for network relevancy and priority.
+* Actors are moved between cells only when they cross a cell border, and once per frame every remote
+* player gets the set of actors in the cells around its view point. The relevancy and priority checks
+* of the tracked actors are then a single lookup in that set instead of a check per actor and connection.
+* The grid is also the broadphase of the radial damage (see AProjectileBase::ApplyRadialDamage).
+*/
+UCLASS(NotPlaceable, Transient)
+class PACBOY_API ANetRelevancyGrid : public AActor
+{
+public:
+
+	/** The size of a grid cell */
+	UPROPERTY(EditAnywhere, Category = "Relevancy")
+	float CellSize;
+
+	/** The distance from the view point at which the actors stop being relevant */
+	UPROPERTY(EditAnywhere, Category = "Relevancy")
+	float RelevantDistance;
+
+	/** The priority scale of the actors at the view point */
+	UPROPERTY(EditAnywhere, Category = "Relevancy")
+	float NearPriorityScale;
+
+	/** The priority scale of the actors at the relevant distance */
+	UPROPERTY(EditAnywhere, Category = "Relevancy")
+	float FarPriorityScale;
+
+	ANetRelevancyGrid(const FObjectInitializer& ObjectInitializer);
+
+	/** Returns the relevancy grid of the world (spawns it on first use). Returns NULL if the world is not a server */
+	static ANetRelevancyGrid* Get(UWorld* World);
+
+	/** Starts tracking the actor, or moves it to its current cell if it is already tracked */
+	void UpdateActor(AActor* Actor);
+
+	/** Stops tracking the actor */
+	void RemoveActor(AActor* Actor);
+
+	/** Returns whether the relevant actors of the player were gathered this frame */
+	bool IsTrackingViewer(const APlayerController* Viewer) const;
+
+	/**
+	* Gathers the tracked actors within a distance of a location
+	* @param Location - The center of the sphere
+	* @param Radius - The radius of the sphere
+	* @param OutActors - Receives the actors whose location is in the sphere
+	*/
+	void GatherActorsInRadius(const FVector& Location, float Radius, TArray<AActor*>& OutActors) const;
+
+	/**
+	* Gathers the tracked actors relevant to a view point
+	* @param ViewLocation - The view point
+	* @param OutActors - Receives the relevant actors and their distance to the view point (squared)
+	*/
+	void GatherRelevantActors(const FVector& ViewLocation, TMap<const AActor*, float>& OutActors) const;
+
+	/** Returns whether the actor is relevant to the player */
+	bool IsRelevantFor(const AActor* Actor, const APlayerController* Viewer) const;
+
+	/**
+	* Returns the net priority scale of the actor for the player (based on its distance to the player's view point)
+	* Returns 0 if the actor is not relevant to the player
+	*/
+	float GetPriorityScale(const AActor* Actor, const APlayerController* Viewer) const;
+
+	virtual void Tick(float DeltaTime) override;
+
+private:
+
+	/** The tracked actors of every cell */
+	TMap<FIntPoint, TArray<AActor*>> Cells;
+
+	/** The current cell of every tracked actor */
+	TMap<const AActor*, FIntPoint> ActorCells;
+
+	/** The relevant actors of every remote player and their distance to the player's view point (squared) */
+	TMap<const APlayerController*, TMap<const AActor*, float>> RelevantActors;
+
+	/** Returns the cell that contains the location */
+	FIntPoint GetCell(const FVector& Location) const;
+
+	/** Gathers the relevant actors of the player */
+	void GatherRelevantActors(const APlayerController* Viewer, TMap<const AActor*, float>& OutActors) const;
+
+	GENERATED_BODY()
+
+};
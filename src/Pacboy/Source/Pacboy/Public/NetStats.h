@@ -0,0 +1,145 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+/** The network stats are compiled out of the shipping builds */
+#define PACBOY_NET_STATS !UE_BUILD_SHIPPING
+
+#if PACBOY_NET_STATS
+
+/** The network traffic of a RPC or of a replicated property on one connection */
+struct FNetStatsEntry
+{
+	/** How many times the RPC was called or the property was sent */
+	int32 Count;
+
+	/** The bits written to the connection */
+	int64 Bits;
+
+	/** The highest number of reliable bunches waiting for an ack on the actor channel after a call */
+	int32 MaxReliableBuffer;
+
+	FNetStatsEntry()
+		: Count(0)
+		, Bits(0)
+		, MaxReliableBuffer(0)
+	{
+	}
+};
+
+/**
+* Counts the calls, the serialized bits and the reliable buffer occupancy of the RPCs,
+* and the sends and bits of the replicated properties, per connection. Disabled by default.
+* Console commands:
+* "Pacboy.NetStats on|off" - Starts or stops counting
+* "Pacboy.NetStats dump" - Prints the stats to the log
+* "Pacboy.NetStats reset" - Clears the stats
+* "Pacboy.NetStats csv <Seconds>" - Appends the stats to Saved/Profiling/NetStats.csv every N seconds, then clears them (0 stops)
+* A dedicated server started with -NetStatsCSV=<Seconds> writes the CSV from the start.
+*/
+class PACBOY_API FNetStats
+{
+public:
+
+	/** Returns whether the stats are being counted */
+	static bool IsEnabled()
+	{
+		return bEnabled;
+	}
+
+	static void SetEnabled(bool bInEnabled);
+
+	/**
+	* Records a RPC sent on a connection (see FNetStatsRPCScope)
+	* @param Connection - The connection the RPC was sent on
+	* @param Function - The RPC
+	* @param Bits - The bits written to the connection
+	* @param ReliableBuffer - The number of reliable bunches waiting for an ack on the actor channel
+	*/
+	static void RecordRPC(UNetConnection* Connection, const UFunction* Function, int64 Bits, int32 ReliableBuffer);
+
+	/** Returns the number of RPCs sent on all connections since the stats were enabled (not cleared by Reset) */
+	static int64 GetTotalRPCs()
+	{
+		return TotalRPCs;
+	}
+
+	/**
+	* Records a replicated property sent to a client. Called by the NetSerialize of the replicated structs
+	* @param Map - The package map of the connection
+	* @param PropertyName - The name of the property
+	* @param Bits - The serialized bits of the property
+	*/
+	static void RecordProperty(UPackageMap* Map, const TCHAR* PropertyName, int64 Bits);
+
+	/** Starts the CSV dump of the dedicated servers started with -NetStatsCSV=<Seconds> */
+	static void InitFromCommandLine();
+
+	/** Prints the stats to the log */
+	static void Dump();
+
+	/** Clears the stats */
+	static void Reset();
+
+	/**
+	* Starts or stops the periodic CSV dump
+	* @param Interval - The time between two dumps (0 stops)
+	*/
+	static void SetCSVInterval(float Interval);
+
+private:
+
+	static bool bEnabled;
+
+	static int64 TotalRPCs;
+
+	/** The stats of every connection, by RPC or property name */
+	static TMap<FString, TMap<FName, FNetStatsEntry>> Connections;
+
+	/** The time between two CSV dumps */
+	static float CSVInterval;
+
+	/** The time since the last CSV dump */
+	static float TimeSinceCSVDump;
+
+	/** The ticker of the CSV dump */
+	static FTickerDelegate CSVTicker;
+
+	/** The CSV file */
+	static FArchive* CSVFile;
+
+	/** Returns the stats of the RPC or property on the connection */
+	static FNetStatsEntry& FindOrAddEntry(UNetConnection* Connection, FName Name);
+
+	/** Appends the stats to the CSV file */
+	static void WriteCSV();
+
+	static bool TickCSV(float DeltaTime);
+};
+
+/** Measures the bits written to the connections of an actor while it sends a RPC */
+class PACBOY_API FNetStatsRPCScope
+{
+public:
+
+	FNetStatsRPCScope(AActor* InActor, UFunction* InFunction);
+
+	~FNetStatsRPCScope();
+
+private:
+
+	AActor* Actor;
+
+	UFunction* Function;
+
+	/** The connections of the actor's net driver (the server connection on clients). Empty when the stats are disabled */
+	TArray<UNetConnection*, TInlineAllocator<16>> Connections;
+
+	/** The bits written to every connection when the RPC was called */
+	TArray<int64, TInlineAllocator<16>> ConnectionBits;
+
+	/** Returns the bits written to the connection since its last stat period */
+	static int64 GetWrittenBits(const UNetConnection* Connection);
+};
+
+#endif
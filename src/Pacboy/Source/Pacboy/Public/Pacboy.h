@@ -4,3 +4,23 @@
 
 #include "Engine.h"
 
+/** Gameplay stats of the project. Shown in game with "stat Pacboy" */
+DECLARE_STATS_GROUP(TEXT("Pacboy"), STATGROUP_Pacboy, STATCAT_Advanced);
+
+DECLARE_LOG_CATEGORY_EXTERN(LogPacboy, Log, All);
+
+/** The cosmetic code (particles, sounds, camera and animation effects) is compiled out of the server builds (PacboyServer target) */
+#define PACBOY_WITH_COSMETICS !UE_SERVER
+
+/**
+* Returns whether the cosmetic effects are played in the world.
+* Always false on dedicated servers, and known at compile time in the server builds
+*/
+FORCEINLINE bool ShouldPlayCosmetics(const UWorld* World)
+{
+#if PACBOY_WITH_COSMETICS
+	return (World != NULL) && (World->GetNetMode() != NM_DedicatedServer);
+#else
+	return false;
+#endif
+}
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "PacboyBotDriver.generated.h"
+
+class ACharacterBase;
+
+namespace EBotProfile
+{
+	enum Type
+	{
+		/** Runs around, sprints, jumps and dashes */
+		Wander,
+		/** Strafes slowly, aims and fires, swaps weapons and reloads */
+		Gunner,
+		/** Both of the above */
+		Mixed,
+		/** Runs in a circle while aiming and firing, jumps every few seconds (the same input every run) */
+		Circle
+	};
+}
+
+/**
+* Plays the local character of a client with generated input, for load testing the dedicated server.
+* Started by running the client with -PacboyBot[=Wander|Gunner|Mixed|Circle] (Mixed by default),
+* usually headless: "UE4Editor Pacboy.uproject 127.0.0.1 -game -nullrhi -nosound -PacboyBot=Mixed".
+* -PacboyBotSeed=<N> makes the randomized profiles repeatable.
+* The character is only driven through its input functions, so the bots load the server like players.
+*/
+UCLASS(NotPlaceable, Transient)
+class PACBOY_API APacboyBotDriver : public AActor
+{
+public:
+
+	APacboyBotDriver(const FObjectInitializer& ObjectInitializer);
+
+	/** Returns whether the command line asks for a bot */
+	static bool IsEnabled();
+
+	/** Returns the bot driver of the world (spawns it on first use) */
+	static APacboyBotDriver* Get(UWorld* World);
+
+	virtual void BeginPlay() override;
+
+	virtual void Tick(float DeltaTime) override;
+
+private:
+
+	/** The behaviour of the bot */
+	EBotProfile::Type Profile;
+
+	/** The random stream of the randomized profiles */
+	FRandomStream Random;
+
+	/** The character driven during the previous tick */
+	TWeakObjectPtr<ACharacterBase> Character;
+
+	/** The time until the next decision */
+	float TimeToDecision;
+
+	/** The time since the character was possessed (used by the scripted profile) */
+	float ScriptTime;
+
+	float ForwardAxis;
+
+	float RightAxis;
+
+	/** The turn speed (degrees per second) */
+	float TurnRate;
+
+	bool bSprinting;
+
+	bool bAiming;
+
+	bool bFiring;
+
+	/** Picks the next input of the randomized profiles and presses the single actions */
+	void Decide(ACharacterBase* InCharacter);
+
+	/** Plays the input of the scripted profile */
+	void PlayScript(ACharacterBase* InCharacter, float DeltaTime);
+
+	/** Presses or releases the held actions whose state changed */
+	void ApplyHeldActions(ACharacterBase* InCharacter, bool bSprint, bool bAim, bool bFire);
+
+	GENERATED_BODY()
+
+};
@@ -5,6 +5,8 @@
 #include "GameFramework/GameMode.h"
 #include "PacboyGameMode.generated.h"
 
+class ACharacterBase;
+
 /**
  * 
  */
@@ -14,8 +16,25 @@ class PACBOY_API APacboyGameMode : public AGameMode
 
 public:
 
+	/** Indicates if the dead characters are reused when their players respawn, instead of spawning new characters */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Game")
+	bool bRecycleCharacters;
+
+	APacboyGameMode(const FObjectInitializer& ObjectInitializer);
+
+	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
+
+	virtual void StartPlay() override;
+
 	virtual void ChangeName(AController* Other, const FString& S, bool bNameChange) override;
 
+	/**
+	* Respawns the player of a dead character by moving the character to a player start and bringing it back to life
+	* @param Character - The dead character
+	* @return false if the character can't be reused (the player must get a new character)
+	*/
+	bool RecycleCharacter(ACharacterBase* Character);
+
 private:
 
 	GENERATED_BODY()
@@ -3,6 +3,7 @@
 #pragma once
 
 #include "GameFramework/Actor.h"
+#include "GameplayTimers.h"
 #include "ProjectileBase.generated.h"
 
 /**
@@ -17,6 +18,18 @@ public:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Projectile")
 	float Damage;
 
+	/** The damage dealt around the impact, at its center (see RadialDamageFalloff) */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Projectile")
+	float RadialDamage;
+
+	/** The radius of the radial damage (0 for none) */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Projectile")
+	float RadialDamageRadius;
+
+	/** The scale of the radial damage over the distance to the impact, from 0 (the center) to 1 (the radius). Linear if not set */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Projectile")
+	UCurveFloat* RadialDamageFalloff;
+
 	/** The impulse force of the projectile on hit */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Projectile")
 	float ImpulseForce;
@@ -37,20 +50,84 @@ public:
 	UPROPERTY(VisibleDefaultsOnly, BlueprintReadOnly, Category = "Projectile")
 	UStaticMeshComponent* ProjectileMesh;
 
+	/** Indicates if the projectile is launched (false while it waits in the projectile pool) */
+	UPROPERTY(ReplicatedUsing = OnRep_InFlight, BlueprintReadOnly, Category = "Projectile")
+	bool bInFlight;
+
+	/** Moves the projectile with the batched projectile simulation instead of its own movement component */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Projectile")
+	bool bUseBatchedSimulation;
+
+	/** The index of the projectile in the batched projectile simulation (INDEX_NONE if not simulated) */
+	int32 SimulationIndex;
+
 	AProjectileBase(const FObjectInitializer& ObjectInitializer);
 
+	/**
+	* Launches the projectile. Used by the projectile pool
+	* @param Location - The launch location
+	* @param Rotation - The launch rotation
+	* @param InShooter - The controller of the player that fired the projectile
+	*/
+	void Launch(const FVector& Location, const FRotator& Rotation, AController* InShooter);
+
+	/** Stops, hides and disables the collision of the projectile. Used by the projectile pool */
+	void Deactivate();
+
+	/** Returns the projectile to the projectile pool */
+	void ReturnToPool();
+
+	/** Called by the batched projectile simulation when the projectile hits something */
+	void ProcessBatchedHit(const FHitResult& Hit);
+
+	/**
+	* Gathers the actors that may take radial damage: the actors of the relevancy grid (see ANetRelevancyGrid),
+	* or an overlap query when the world has no grid
+	* @param World - The world of the damage
+	* @param Location - The center of the damage
+	* @param Radius - The radius of the damage
+	* @param OutActors - Receives the candidates (they still need to be checked for line of sight)
+	*/
+	static void GatherRadialDamageCandidates(UWorld* World, const FVector& Location, float Radius, TArray<AActor*>& OutActors);
+
+	virtual void GetLifetimeReplicatedProps(TArray< class FLifetimeProperty > & OutLifetimeProps) const override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	virtual void Tick(float DeltaTime) override;
+
+	/** Uses the relevancy grid (see ANetRelevancyGrid) when it tracks the player */
+	virtual bool IsNetRelevantFor(APlayerController* RealViewer, AActor* Viewer, const FVector& SrcLocation) override;
+
+	/** Scales the priority with the distance to the player when the relevancy grid tracks the player */
+	virtual float GetNetPriority(const FVector& ViewPos, const FVector& ViewDir, APlayerController* Viewer, UActorChannel* InChannel, float Time, bool bLowBandwidth) override;
+
 	/** Called when the projectile hits something (to apply effects) */
 	UFUNCTION(BlueprintImplementableEvent, Category = "Projectile")
 	void OnImpact(AActor* OtherActor, UPrimitiveComponent* OtherComp);
 
 protected:
 
+	/** Launches or deactivates the proxy of the projectile when the server launches it or returns it to the pool */
+	UFUNCTION()
+	virtual void OnRep_InFlight();
+
 	/** Called when the projectile hits something (to apply damage) */
 	UFUNCTION()
 	virtual void OnHit(AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
 
+	/**
+	* Damages the damageable actors around the impact that can see it (done by the server)
+	* @param Hit - The impact
+	* @param DirectHitActor - The actor hit by the projectile (it only takes the impact damage)
+	*/
+	void ApplyRadialDamage(const FHitResult& Hit, const AActor* DirectHitActor);
+
 private:
 
+	/** Returns the projectile to the pool at the end of its life span */
+	FGameplayTimerHandle LifeSpanTimer;
+
 	GENERATED_BODY()
 
 };
@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "ProjectileBase.h"
+#include "GameFramework/Actor.h"
+#include "ProjectilePool.generated.h"
+
+/**
+* The pooled projectiles of one projectile class
+*/
+USTRUCT()
+struct FProjectilePoolBucket
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** The projectile class of this bucket */
+	UPROPERTY()
+	TSubclassOf<AProjectileBase> ProjectileClass;
+
+	/** Inactive projectiles, ready to be launched */
+	UPROPERTY()
+	TArray<AProjectileBase*> FreeProjectiles;
+
+	/** The number of projectiles of this class currently in flight */
+	int32 ActiveCount;
+
+	FProjectilePoolBucket()
+		: ActiveCount(0)
+	{
+	}
+};
+
+/**
+* Per-world pool of projectile actors. Projectiles are spawned once and then
+* launched and returned to the pool instead of being spawned and destroyed per shot.
+*/
+UCLASS(NotPlaceable, Transient)
+class PACBOY_API AProjectilePool : public AActor
+{
+public:
+
+	/** How many launches were served by an already pooled projectile */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = "Stats")
+	int32 PoolHits;
+
+	/** How many launches had to spawn a new projectile */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = "Stats")
+	int32 PoolMisses;
+
+	/** The highest number of projectiles that were in flight at the same time */
+	UPROPERTY(VisibleInstanceOnly, BlueprintReadOnly, Category = "Stats")
+	int32 HighWaterMark;
+
+	AProjectilePool(const FObjectInitializer& ObjectInitializer);
+
+	/** Returns the projectile pool of the world (spawns it on first use), NULL on the clients */
+	static AProjectilePool* Get(UWorld* World);
+
+	/**
+	* Makes sure that the pool holds at least Count projectiles of the given class
+	* @param ProjectileClass - The class of the projectiles
+	* @param Count - The number of projectiles to keep around
+	*/
+	void Prewarm(TSubclassOf<AProjectileBase> ProjectileClass, int32 Count);
+
+	/**
+	* Launches a projectile from the pool (spawns a new one if the pool is empty)
+	* @param ProjectileClass - The class of the projectile
+	* @param Location - The launch location
+	* @param Rotation - The launch rotation
+	* @param Shooter - The controller of the player that fired the projectile
+	*/
+	AProjectileBase* Acquire(TSubclassOf<AProjectileBase> ProjectileClass, const FVector& Location, const FRotator& Rotation, AController* Shooter);
+
+	/** Deactivates the projectile and puts it back in the pool */
+	void Release(AProjectileBase* Projectile);
+
+private:
+
+	/** The pooled projectiles, one bucket per projectile class */
+	UPROPERTY()
+	TArray<FProjectilePoolBucket> Buckets;
+
+	/** The number of projectiles currently in flight (all classes) */
+	int32 ActiveCount;
+
+	FProjectilePoolBucket& FindOrAddBucket(TSubclassOf<AProjectileBase> ProjectileClass);
+
+	AProjectileBase* SpawnPooledProjectile(TSubclassOf<AProjectileBase> ProjectileClass);
+
+	GENERATED_BODY()
+
+};
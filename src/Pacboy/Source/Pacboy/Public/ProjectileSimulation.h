@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "ProjectileSimulation.generated.h"
+
+class AProjectileBase;
+
+/**
+* Moves all projectiles that use batched simulation in a single pass per frame.
+* The projectile state is stored as parallel arrays (one entry per projectile) instead of
+* one projectile movement and collision component tick and sweep per projectile.
+*/
+UCLASS(NotPlaceable, Transient)
+class PACBOY_API AProjectileSimulation : public AActor
+{
+public:
+
+	AProjectileSimulation(const FObjectInitializer& ObjectInitializer);
+
+	/** Returns the projectile simulation of the world (spawns it on first use) */
+	static AProjectileSimulation* Get(UWorld* World);
+
+	/**
+	* Starts simulating the projectile
+	* @param Projectile - The launched projectile
+	* @param Location - The launch location
+	* @param Velocity - The launch velocity
+	*/
+	void Add(AProjectileBase* Projectile, const FVector& Location, const FVector& Velocity);
+
+	/** Stops simulating the projectile */
+	void Remove(AProjectileBase* Projectile);
+
+	/** Returns the number of simulated projectiles */
+	int32 Num() const;
+
+	virtual void Tick(float DeltaTime) override;
+
+private:
+
+	/** The simulated projectiles (the actors are only used for visuals and impact events) */
+	UPROPERTY()
+	TArray<AProjectileBase*> Projectiles;
+
+	/** The controllers of the players that fired the projectiles */
+	UPROPERTY()
+	TArray<AController*> Shooters;
+
+	TArray<FVector> Positions;
+
+	TArray<FVector> PreviousPositions;
+
+	TArray<FVector> Velocities;
+
+	TArray<float> GravityZ;
+
+	TArray<float> Radii;
+
+	TArray<TEnumAsByte<ECollisionChannel>> CollisionChannels;
+
+	TArray<FCollisionResponseParams> CollisionResponses;
+
+	/** The indices of the projectiles that hit something this frame (kept between frames to avoid reallocating it) */
+	TArray<int32> HitIndices;
+
+	/** The hits of the projectiles of HitIndices */
+	TArray<FHitResult> Hits;
+
+	/** The projectiles of HitIndices (the impacts remove projectiles from the arrays) */
+	UPROPERTY()
+	TArray<AProjectileBase*> HitProjectiles;
+
+	/** Integrates the movement of all projectiles */
+	void Integrate(float DeltaTime);
+
+	/** Sweeps every projectile from its previous to its current position and collects the hits in HitIndices and Hits */
+	void SweepProjectiles();
+
+	GENERATED_BODY()
+
+};
@@ -0,0 +1,103 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "SignificanceManager.generated.h"
+
+class ACharacterBase;
+
+UENUM()
+namespace ECharacterSignificance
+{
+	enum Type
+	{
+		/** Updated at full rate */
+		High,
+		/** Ticked at a lower rate */
+		Medium,
+		/** Ticked at the lowest rate, animated only while rendered and moved without smoothing */
+		Low
+	};
+}
+
+/**
+* Lowers the update cost of the simulated characters that matter little to the local players.
+* Once per frame every character gets a score from its distance to the closest local view point
+* and from whether it is seen. The best scored characters are updated at full rate, up to a budget,
+* and the rest get a lower tick rate, animation update rate and movement smoothing.
+* Only the simulated proxies are affected, so nothing that the gameplay depends on changes.
+*/
+UCLASS(NotPlaceable, Transient)
+class PACBOY_API ASignificanceManager : public AActor
+{
+public:
+
+	/** The distance from the view point at which the score of the characters drops to zero */
+	UPROPERTY(EditAnywhere, Category = "Significance")
+	float MaxSignificanceDistance;
+
+	/** The score multiplier of the characters that are behind the view point or were not rendered recently */
+	UPROPERTY(EditAnywhere, Category = "Significance")
+	float HiddenScoreScale;
+
+	/** How long a character counts as seen after it was last rendered */
+	UPROPERTY(EditAnywhere, Category = "Significance")
+	float RecentlyRenderedTime;
+
+	/** The characters scored below this are of low significance, even when the budgets are not used up */
+	UPROPERTY(EditAnywhere, Category = "Significance")
+	float MinMediumScore;
+
+	/** The maximum number of characters of high significance per frame */
+	UPROPERTY(EditAnywhere, Category = "Significance")
+	int32 MaxHighSignificance;
+
+	/** The maximum number of characters of medium significance per frame */
+	UPROPERTY(EditAnywhere, Category = "Significance")
+	int32 MaxMediumSignificance;
+
+	/** The tick interval of the characters of medium significance */
+	UPROPERTY(EditAnywhere, Category = "Significance")
+	float MediumTickInterval;
+
+	/** The tick interval of the characters of low significance */
+	UPROPERTY(EditAnywhere, Category = "Significance")
+	float LowTickInterval;
+
+	ASignificanceManager(const FObjectInitializer& ObjectInitializer);
+
+	/** Returns the significance manager of the world (spawns it on first use). Returns NULL if the world doesn't play cosmetic effects */
+	static ASignificanceManager* Get(UWorld* World);
+
+	/** Starts scoring the character */
+	void RegisterCharacter(ACharacterBase* Character);
+
+	/** Stops scoring the character */
+	void UnregisterCharacter(ACharacterBase* Character);
+
+	virtual void Tick(float DeltaTime) override;
+
+private:
+
+	/** The scored characters */
+	TArray<ACharacterBase*> Characters;
+
+	/** The simulated characters of this frame, the best scored first */
+	TArray<ACharacterBase*> ScoredCharacters;
+
+	/** The view points of the local players of this frame */
+	TArray<FVector> ViewLocations;
+
+	/** The view directions of the local players of this frame */
+	TArray<FVector> ViewDirections;
+
+	/** Returns the score of the character for the local view points (0 - 1) */
+	float ScoreCharacter(const ACharacterBase* Character) const;
+
+	/** Applies the significance and its settings to the character */
+	void ApplySignificance(ACharacterBase* Character, ECharacterSignificance::Type Significance) const;
+
+	GENERATED_BODY()
+
+};
@@ -2,32 +2,56 @@
 
 #pragma once
 
-#include "ProjectileBase.h"
+#include "WeaponDefinition.h"
 #include "GameFramework/Actor.h"
 #include "Weapon.generated.h"
 
-UENUM(BlueprintType)
-namespace EWeaponType
-{
-	enum Type
-	{
-		Melee,
-		Pistol,
-		Rifle,
-		Sniper,
-		RocketLauncher
-	};
-}
-
-UENUM(BlueprintType)
-namespace EWeaponShootingType
+/**
+* Schedules the shots of an automatic weapon at the exact times they are due, independently of the frame rate.
+* Every shot that became due since the last update is returned with its age, so a low tick rate
+* fires several shots in a frame instead of dropping or delaying them
+*/
+struct PACBOY_API FWeaponFireScheduler
 {
-	enum Type
-	{
-		Instant,
-		Projectile
-	};
-}
+public:
+
+	/** The maximum number of shots returned by a single update (avoids bursts after long hitches) */
+	static const int32 MaxShotsPerAdvance = 8;
+
+	FWeaponFireScheduler();
+
+	/**
+	* Starts scheduling the shots (does nothing if already armed)
+	* @param Time - The time of the first shot, unless the weapon is still cooling down from the last one
+	*/
+	void Arm(float Time);
+
+	/** Stops scheduling the shots. The cool down of the last shot is kept */
+	void Disarm();
+
+	/** Returns whether the shots are being scheduled */
+	bool IsArmed() const;
+
+	/**
+	* Consumes the shots due up to the time
+	* @param Time - The current time
+	* @param ShotInterval - The time between two shots
+	* @param OutFirstShotAge - The time since the first due shot was due (the others follow every ShotInterval)
+	* @return The number of due shots
+	*/
+	int32 Advance(float Time, float ShotInterval, float& OutFirstShotAge);
+
+private:
+
+	/** Indicates if the shots are being scheduled */
+	bool bArmed;
+
+	/** The time left until the next shot is due (negative when it is late) */
+	float TimeToNextShot;
+
+	/** The time of the last update, the elapsed time is subtracted from TimeToNextShot */
+	float LastUpdateTime;
+};
 
 /**
 *
@@ -37,28 +61,9 @@ class PACBOY_API AWeapon : public AActor
 {
 public:
 
-	/** Initializes the weapon by copying the properties of another weapon */
-	void Init(const AWeapon& Weapon);
-
-	/** The type of the weapon */
+	/** The static properties of the weapon, shared by all the weapons of the class. Must be set by the weapon classes */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
-	TEnumAsByte<EWeaponType::Type> WeaponType;
-
-	/** The shooting type of the weapon */
-	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon")
-	TEnumAsByte<EWeaponShootingType::Type> ShootingType;
-
-	/** Weapon damage. Used when shooting type is instant */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon")
-	float Damage;
-
-	/** The ammo capacity of the weapon */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ammo")
-	int32 AmmoCapacity;
-
-	/** The ammo clip capacity */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ammo")
-	int32 ClipCapacity;
+	UWeaponDefinition* Definition;
 
 	/** The remaining ammo of the weapon */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ammo")
@@ -68,42 +73,70 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Ammo")
 	int32 AmmoInClip;
 
-	/** The socket name of the gun's muzzle */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Weapon")
-	FName GunMuzzleSocketName;
-
-	/** How many shots can this weapon fire per second */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Gameplay")
-	int32 ShotsPerSecond;
-
-	/** Projectile class to spawn */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Projectile")
-	TSubclassOf<AProjectileBase> ProjectileClass;
-
 	/** The weapon mesh */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
 	USkeletalMeshComponent* WeaponMesh;
 
-	/** The weapon impact effect. Used for instant type weapons */
-	UPROPERTY(EditDefaultsOnly, Category = "Effects")
-	UParticleSystem* WeaponImpactFX;
+	/** The automatic fire state of the weapon */
+	FWeaponFireScheduler FireScheduler;
 
-	/** The weapon shot effect */
-	UPROPERTY(EditDefaultsOnly, Category = "Effects")
-	UParticleSystem* WeaponShotFX;
+	AWeapon(const FObjectInitializer& ObjectInitializer);
 
-	/** The weapon shot sound effect */
-	UPROPERTY(EditDefaultsOnly, Category = "Effects")
-	USoundBase* WeaponShotSFX;
+	/** Returns the definition of the weapon (the defaults of UWeaponDefinition if the class has none) */
+	const UWeaponDefinition* GetDefinition() const
+	{
+		return (this->Definition != NULL) ? this->Definition : GetDefault<UWeaponDefinition>();
+	}
 
-	AWeapon(const FObjectInitializer& ObjectInitializer);
+	/** Gives the weapon the ammo of a new weapon and stops its automatic fire */
+	void Init();
+
+	/** Returns the time between two shots */
+	float GetShotInterval() const;
 
 	/** Reloads the weapon */
 	UFUNCTION(BlueprintCallable, Category = "Weapon")
 	void Reload();
 
+	/** Makes a definition out of the legacy properties of a weapon saved before UWeaponDefinition */
+	virtual void PostLoad() override;
+
 private:
 
+	/** The static properties saved by the weapons made before UWeaponDefinition (only read by PostLoad) */
+	UPROPERTY()
+	TEnumAsByte<EWeaponType::Type> WeaponType_DEPRECATED;
+
+	UPROPERTY()
+	TEnumAsByte<EWeaponShootingType::Type> ShootingType_DEPRECATED;
+
+	UPROPERTY()
+	float Damage_DEPRECATED;
+
+	UPROPERTY()
+	int32 AmmoCapacity_DEPRECATED;
+
+	UPROPERTY()
+	int32 ClipCapacity_DEPRECATED;
+
+	UPROPERTY()
+	FName GunMuzzleSocketName_DEPRECATED;
+
+	UPROPERTY()
+	int32 ShotsPerSecond_DEPRECATED;
+
+	UPROPERTY()
+	TSubclassOf<AProjectileBase> ProjectileClass_DEPRECATED;
+
+	UPROPERTY()
+	UParticleSystem* WeaponImpactFX_DEPRECATED;
+
+	UPROPERTY()
+	UParticleSystem* WeaponShotFX_DEPRECATED;
+
+	UPROPERTY()
+	USoundBase* WeaponShotSFX_DEPRECATED;
+
 	GENERATED_BODY()
 
 };
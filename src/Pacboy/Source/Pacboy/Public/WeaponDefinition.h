@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "ProjectileBase.h"
+#include "Engine/DataAsset.h"
+#include "WeaponDefinition.generated.h"
+
+UENUM(BlueprintType)
+namespace EWeaponType
+{
+	enum Type
+	{
+		Melee,
+		Pistol,
+		Rifle,
+		Sniper,
+		RocketLauncher
+	};
+}
+
+UENUM(BlueprintType)
+namespace EWeaponShootingType
+{
+	enum Type
+	{
+		Instant,
+		Projectile
+	};
+}
+
+/**
+* The static properties of a weapon archetype. A single asset is shared by all the weapons of a class
+* (see AWeapon::Definition), which only keep their ammo and fire state. Never modified at runtime
+*/
+UCLASS(BlueprintType)
+class PACBOY_API UWeaponDefinition : public UDataAsset
+{
+public:
+
+	/** The type of the weapon */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	TEnumAsByte<EWeaponType::Type> WeaponType;
+
+	/** The shooting type of the weapon */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	TEnumAsByte<EWeaponShootingType::Type> ShootingType;
+
+	/** Weapon damage. Used when shooting type is instant */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	float Damage;
+
+	/** The maximum distance of the hits. Used when shooting type is instant */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	float Range;
+
+	/** The ammo capacity of the weapon */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Ammo")
+	int32 AmmoCapacity;
+
+	/** The ammo clip capacity */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Ammo")
+	int32 ClipCapacity;
+
+	/** The remaining ammo of a new weapon */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Ammo")
+	int32 InitialRemainingAmmo;
+
+	/** The amount of ammo in the clip of a new weapon */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Ammo")
+	int32 InitialAmmoInClip;
+
+	/** The socket name of the gun's muzzle */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	FName GunMuzzleSocketName;
+
+	/** How many shots can this weapon fire per second */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Gameplay")
+	int32 ShotsPerSecond;
+
+	/** Projectile class to spawn */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Projectile")
+	TSubclassOf<AProjectileBase> ProjectileClass;
+
+	/** The weapon impact effect. Used for instant type weapons */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Effects")
+	UParticleSystem* WeaponImpactFX;
+
+	/** The weapon shot effect */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Effects")
+	UParticleSystem* WeaponShotFX;
+
+	/** The weapon shot sound effect */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Effects")
+	USoundBase* WeaponShotSFX;
+
+	UWeaponDefinition(const FObjectInitializer& ObjectInitializer);
+
+	/** Returns the time between two shots */
+	float GetShotInterval() const;
+
+private:
+
+	GENERATED_BODY()
+
+};
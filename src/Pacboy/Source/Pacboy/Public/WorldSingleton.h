@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "EngineUtils.h"
+
+/**
+* Returns the only actor of the given class in the world, spawning it on first use.
+* Used by the per-world managers that don't belong to any player (pools, queues, etc.).
+* The actor is cached per world (PIE and listen servers run several worlds in one process).
+* Spawns in any world that asks: the callers check the net mode of the world
+* @param World - The world that owns the actor
+*/
+template<typename T>
+T* GetWorldSingleton(UWorld* World)
+{
+	if (World == NULL)
+	{
+		return NULL;
+	}
+
+	static TMap<TWeakObjectPtr<UWorld>, TWeakObjectPtr<T>> CachedActors;
+
+	TWeakObjectPtr<T>* CachedActor = CachedActors.Find(World);
+	if ((CachedActor != NULL) && CachedActor->IsValid() && !(*CachedActor)->IsPendingKill())
+	{
+		return CachedActor->Get();
+	}
+
+	// Forget the worlds that were destroyed since the last miss
+	for (auto It = CachedActors.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid() || !It.Value().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	for (TActorIterator<T> It(World); It; ++It)
+	{
+		if (!It->IsPendingKill())
+		{
+			CachedActors.Add(World, *It);
+			return *It;
+		}
+	}
+
+	if (World->bIsTearingDown)
+	{
+		return NULL;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.bNoCollisionFail = true;
+
+	T* Actor = World->SpawnActor<T>(SpawnParams);
+	if (Actor != NULL)
+	{
+		CachedActors.Add(World, Actor);
+	}
+
+	return Actor;
+}
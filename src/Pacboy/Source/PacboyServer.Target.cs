@@ -0,0 +1,26 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+using UnrealBuildTool;
+using System.Collections.Generic;
+
+public class PacboyServerTarget : TargetRules
+{
+	public PacboyServerTarget(TargetInfo Target)
+	{
+		// Server builds define UE_SERVER, which compiles out the cosmetic code (see PACBOY_WITH_COSMETICS)
+		Type = TargetType.Server;
+	}
+
+	//
+	// TargetRules interface.
+	//
+
+	public override void SetupBinaries(
+		TargetInfo Target,
+		ref List<UEBuildBinaryConfiguration> OutBuildBinaryConfigurations,
+		ref List<string> OutExtraModuleNames
+		)
+	{
+		OutExtraModuleNames.AddRange( new string[] { "Pacboy" } );
+	}
+}